@@ -0,0 +1,177 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TESTING_BYTE_ORDER_H
+#define TESTING_BYTE_ORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace testing{
+
+    // Byte order of the multi-byte fields of requests, responses and event data. Big endian is the default, the native byte order of the host can be negotiated with HELLO (CAPABILITY_NATIVE_BYTE_ORDER), because both ends of a channel run on the same host.
+    enum byte_order{
+        BYTE_ORDER_BIG_ENDIAN, BYTE_ORDER_NATIVE
+    };
+
+    // Checks if values have to be byte swapped to be stored in the byte order on this host.
+    constexpr bool byte_order_swaps(byte_order order){
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return false;
+#else
+        return order == BYTE_ORDER_BIG_ENDIAN;
+#endif
+    }
+
+    // Stores a value at buffer (unaligned) in the byte order.
+    inline void store_uint16(uint16_t value, char* buffer, byte_order order){
+        if(byte_order_swaps(order)) value = __builtin_bswap16(value);
+        memcpy(buffer, &value, sizeof(value));
+    }
+
+    inline void store_uint32(uint32_t value, char* buffer, byte_order order){
+        if(byte_order_swaps(order)) value = __builtin_bswap32(value);
+        memcpy(buffer, &value, sizeof(value));
+    }
+
+    inline void store_uint64(uint64_t value, char* buffer, byte_order order){
+        if(byte_order_swaps(order)) value = __builtin_bswap64(value);
+        memcpy(buffer, &value, sizeof(value));
+    }
+
+    // Loads a value from buffer (unaligned) in the byte order.
+    inline uint16_t load_uint16(const char* buffer, byte_order order){
+        uint16_t value;
+        memcpy(&value, buffer, sizeof(value));
+        return byte_order_swaps(order) ? __builtin_bswap16(value) : value;
+    }
+
+    inline uint32_t load_uint32(const char* buffer, byte_order order){
+        uint32_t value;
+        memcpy(&value, buffer, sizeof(value));
+        return byte_order_swaps(order) ? __builtin_bswap32(value) : value;
+    }
+
+    inline uint64_t load_uint64(const char* buffer, byte_order order){
+        uint64_t value;
+        memcpy(&value, buffer, sizeof(value));
+        return byte_order_swaps(order) ? __builtin_bswap64(value) : value;
+    }
+
+    // Copies count 32 bit words from src to dest and reverses the bytes of each word, using SIMD instructions if available.
+    inline void byte_swap_copy32(char* dest, const char* src, size_t count){
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        const __m256i mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        for(; i + 8 <= count; i += 8){
+            _mm256_storeu_si256((__m256i*)(dest + i * 4), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(src + i * 4)), mask));
+        }
+#elif defined(__SSSE3__)
+        const __m128i mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        for(; i + 4 <= count; i += 4){
+            _mm_storeu_si128((__m128i*)(dest + i * 4), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i * 4)), mask));
+        }
+#elif defined(__ARM_NEON)
+        for(; i + 4 <= count; i += 4){
+            vst1q_u8((uint8_t*)dest + i * 4, vrev32q_u8(vld1q_u8((const uint8_t*)src + i * 4)));
+        }
+#endif
+
+        for(; i < count; i++){
+            uint32_t value;
+            memcpy(&value, src + i * 4, sizeof(value));
+            value = __builtin_bswap32(value);
+            memcpy(dest + i * 4, &value, sizeof(value));
+        }
+    }
+
+    // Copies count 64 bit words from src to dest and reverses the bytes of each word, using SIMD instructions if available.
+    inline void byte_swap_copy64(char* dest, const char* src, size_t count){
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        const __m256i mask = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+        for(; i + 4 <= count; i += 4){
+            _mm256_storeu_si256((__m256i*)(dest + i * 8), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(src + i * 8)), mask));
+        }
+#elif defined(__SSSE3__)
+        const __m128i mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+        for(; i + 2 <= count; i += 2){
+            _mm_storeu_si128((__m128i*)(dest + i * 8), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i * 8)), mask));
+        }
+#elif defined(__ARM_NEON)
+        for(; i + 2 <= count; i += 2){
+            vst1q_u8((uint8_t*)dest + i * 8, vrev64q_u8(vld1q_u8((const uint8_t*)src + i * 8)));
+        }
+#endif
+
+        for(; i < count; i++){
+            uint64_t value;
+            memcpy(&value, src + i * 8, sizeof(value));
+            value = __builtin_bswap64(value);
+            memcpy(dest + i * 8, &value, sizeof(value));
+        }
+    }
+
+    // Stores an array of values at buffer in the byte order, for example a table of addresses or lengths.
+    inline void store_uint32_array(const uint32_t* values, size_t count, char* buffer, byte_order order){
+        if(byte_order_swaps(order)){
+            byte_swap_copy32(buffer, reinterpret_cast<const char*>(values), count);
+        }else{
+            memcpy(buffer, values, count * sizeof(uint32_t));
+        }
+    }
+
+    inline void store_uint64_array(const uint64_t* values, size_t count, char* buffer, byte_order order){
+        if(byte_order_swaps(order)){
+            byte_swap_copy64(buffer, reinterpret_cast<const char*>(values), count);
+        }else{
+            memcpy(buffer, values, count * sizeof(uint64_t));
+        }
+    }
+
+    // Loads an array of values from buffer in the byte order.
+    inline void load_uint32_array(const char* buffer, size_t count, uint32_t* values, byte_order order){
+        if(byte_order_swaps(order)){
+            byte_swap_copy32(reinterpret_cast<char*>(values), buffer, count);
+        }else{
+            memcpy(values, buffer, count * sizeof(uint32_t));
+        }
+    }
+
+    inline void load_uint64_array(const char* buffer, size_t count, uint64_t* values, byte_order order){
+        if(byte_order_swaps(order)){
+            byte_swap_copy64(reinterpret_cast<char*>(values), buffer, count);
+        }else{
+            memcpy(values, buffer, count * sizeof(uint64_t));
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,325 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TESTING_COVERAGE_MAP_H
+#define TESTING_COVERAGE_MAP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define MAP_SIZE_POW2 16
+#define MAP_SIZE (1 << MAP_SIZE_POW2)
+
+// Enables the log of touched entries of the coverage map. Can be set to 0 to get the plain memset / memcpy behaviour.
+#ifndef COVERAGE_DIRTY_TRACKING
+#define COVERAGE_DIRTY_TRACKING 1
+#endif
+
+namespace testing{
+
+    // Adds the counters of src to dest with saturation at 255, using SIMD instructions if available. This is used to merge coverage maps.
+    inline void coverage_add_saturating(uint8_t* dest, const uint8_t* src, size_t size){
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        for(; i + 32 <= size; i += 32){
+            __m256i sum = _mm256_adds_epu8(_mm256_loadu_si256((const __m256i*)(dest + i)), _mm256_loadu_si256((const __m256i*)(src + i)));
+            _mm256_storeu_si256((__m256i*)(dest + i), sum);
+        }
+#elif defined(__SSE2__)
+        for(; i + 16 <= size; i += 16){
+            __m128i sum = _mm_adds_epu8(_mm_loadu_si128((const __m128i*)(dest + i)), _mm_loadu_si128((const __m128i*)(src + i)));
+            _mm_storeu_si128((__m128i*)(dest + i), sum);
+        }
+#elif defined(__ARM_NEON)
+        for(; i + 16 <= size; i += 16){
+            vst1q_u8(dest + i, vqaddq_u8(vld1q_u8(dest + i), vld1q_u8(src + i)));
+        }
+#endif
+
+        for(; i < size; i++){
+            unsigned int sum = dest[i] + src[i];
+            dest[i] = sum > 255 ? 255 : sum;
+        }
+    }
+
+    // Lookup table for the classification of hit counts into AFL style buckets (1, 2, 3, 4-7, 8-15, 16-31, 32-127, 128-255), each represented by one bit.
+    struct coverage_bucket_table{
+        uint8_t buckets[256];
+
+        constexpr coverage_bucket_table():buckets(){
+            for(int count = 1; count < 256; count++){
+                if(count <= 2) buckets[count] = count;
+                else if(count == 3) buckets[count] = 4;
+                else if(count <= 7) buckets[count] = 8;
+                else if(count <= 15) buckets[count] = 16;
+                else if(count <= 31) buckets[count] = 32;
+                else if(count <= 127) buckets[count] = 64;
+                else buckets[count] = 128;
+            }
+        }
+    };
+
+    inline constexpr coverage_bucket_table COVERAGE_BUCKETS{};
+
+    // Returns the bucket bit of a hit count.
+    inline uint8_t coverage_bucket(uint8_t count){
+        return COVERAGE_BUCKETS.buckets[count];
+    }
+
+    // Hash contribution of one map entry with a non zero bucket. The contributions of all entries are summed, so the hash of a map does not depend on the order in which its entries are visited.
+    inline uint64_t coverage_entry_hash(size_t index, uint8_t bucket){
+        // splitmix64 finalizer
+        uint64_t x = (((uint64_t)index << 8) | bucket) + 0x9E3779B97F4A7C15;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+        return x ^ (x >> 31);
+    }
+
+    // Calculates the 64 bit hash of the bucketed counters of a coverage map, so runs with the same coverage (up to the bucket of the hit counts) have the same hash.
+    inline uint64_t coverage_hash(const uint8_t* data, size_t size){
+        uint64_t hash = 0;
+        for(size_t i = 0; i < size; i++){
+            if(data[i] != 0) hash += coverage_entry_hash(i, coverage_bucket(data[i]));
+        }
+        return hash;
+    }
+
+    // Merges the bucketed counters of a coverage map into a map of already seen buckets (same size). Returns true if a bucket was not seen before, so the coverage contains something new.
+    inline bool coverage_update_seen(uint8_t* seen, const uint8_t* data, size_t size){
+        bool new_coverage = false;
+        for(size_t i = 0; i < size; i++){
+            uint8_t bucket = coverage_bucket(data[i]);
+            if(bucket & ~seen[i]){
+                seen[i] |= bucket;
+                new_coverage = true;
+            }
+        }
+        return new_coverage;
+    }
+
+    // Returns the shift of the entry at index inside the 64 bit word of a map that contains it.
+    inline unsigned int coverage_word_shift(size_t index){
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return (7 - (index & 7)) * 8;
+#else
+        return (index & 7) * 8;
+#endif
+    }
+
+    // Sets bucket bits in a word of a map of seen buckets that is shared with other processes. Returns true if one of the bits was not set before (by any process).
+    inline bool coverage_set_seen_word(uint64_t* seen_word, uint64_t buckets){
+        // The plain load avoids the locked instruction (and taking the cache line from the other processes) if the buckets are already known, which is the common case.
+        if(!(buckets & ~__atomic_load_n(seen_word, __ATOMIC_RELAXED))) return false;
+
+        return (buckets & ~__atomic_fetch_or(seen_word, buckets, __ATOMIC_RELAXED)) != 0;
+    }
+
+    // Same as coverage_update_seen, but for a map of seen buckets that is shared with other processes (8 byte aligned, size a multiple of 8). The buckets are merged with atomic operations on 64 bit words, so concurrent merges do not lose bits and only the process that sets a bit first reports it as new.
+    inline bool coverage_update_seen_shared(uint8_t* seen, const uint8_t* data, size_t size){
+        uint64_t* seen_words = reinterpret_cast<uint64_t*>(seen);
+        bool new_coverage = false;
+
+        for(size_t i = 0; i < size; i += 8){
+            uint64_t counters;
+            memcpy(&counters, data + i, sizeof(counters));
+            if(counters == 0) continue;
+
+            uint8_t buckets[8];
+            for(size_t j = 0; j < 8; j++) buckets[j] = coverage_bucket(data[i + j]);
+
+            uint64_t bucket_word;
+            memcpy(&bucket_word, buckets, sizeof(bucket_word));
+            new_coverage |= coverage_set_seen_word(&seen_words[i / 8], bucket_word);
+        }
+
+        return new_coverage;
+    }
+
+    // Coverage map with SIZE hit counters. If DIRTY_TRACKING is enabled, hit maintains a log of the entries that were touched since the last reset. Resetting, reading back and iterating the map then only touches the logged entries, so the cost scales with the coverage of a run and not with the map size. If more entries are touched than the log can hold, the map falls back to the plain memset / memcpy.
+    template<size_t SIZE, bool DIRTY_TRACKING>
+    class basic_coverage_map{
+
+        static_assert((SIZE & (SIZE - 1)) == 0 && SIZE >= 64, "The coverage map size must be a power of two.");
+
+        public:
+
+            // Maximum number of logged entries. Above this, the plain memset / memcpy is faster anyway.
+            static constexpr size_t LOG_CAPACITY = SIZE / 16;
+
+            // Creates an empty (all zero) coverage map.
+            basic_coverage_map(){
+                memset(m_bb_array, 0, SIZE);
+            }
+
+            // Returns the number of entries of the map.
+            static constexpr size_t size(){
+                return SIZE;
+            }
+
+            // Increments the counter at the given index (must be smaller than SIZE). The counter skips zero when it overflows (255 -> 1), so a touched entry never looks untouched. The index is logged branch free when the entry is touched the first time.
+            inline void hit(size_t index){
+                uint8_t count = m_bb_array[index];
+                m_bb_array[index] = count + 1 + (count == 255);
+
+                if constexpr(DIRTY_TRACKING){
+                    m_touched[m_touched_count < LOG_CAPACITY ? m_touched_count : LOG_CAPACITY] = (uint32_t)index;
+                    m_touched_count += (count == 0);
+                }
+            }
+
+            // Writes zeros to the whole map. With dirty tracking only the logged entries are cleared.
+            void reset(){
+                if constexpr(DIRTY_TRACKING){
+                    if(!is_log_overflowed()){
+                        for(size_t i = 0; i < m_touched_count; i++) m_bb_array[m_touched[i]] = 0;
+                    }else{
+                        memset(m_bb_array, 0, SIZE);
+                    }
+
+                    m_touched_count = 0;
+                }else{
+                    memset(m_bb_array, 0, SIZE);
+                }
+            }
+
+            // Copies the whole map (SIZE bytes) to dest. With dirty tracking and very sparse coverage the destination is zeroed and only the logged entries are copied, without reading the rest of the map. For denser coverage the scattered copy is slower than one memcpy.
+            void copy_to(uint8_t* dest) const {
+                if constexpr(DIRTY_TRACKING){
+                    if(m_touched_count <= SIZE / 256){
+                        memset(dest, 0, SIZE);
+                        for(size_t i = 0; i < m_touched_count; i++) dest[m_touched[i]] = m_bb_array[m_touched[i]];
+                        return;
+                    }
+                }
+
+                memcpy(dest, m_bb_array, SIZE);
+            }
+
+            // Adds the counters of this map to dest (SIZE bytes) with saturation. With dirty tracking and very sparse coverage only the logged entries are added, otherwise the whole map is added with SIMD instructions.
+            void merge_into(uint8_t* dest) const {
+                if constexpr(DIRTY_TRACKING){
+                    if(m_touched_count <= SIZE / 256){
+                        for(size_t i = 0; i < m_touched_count; i++){
+                            unsigned int sum = dest[m_touched[i]] + m_bb_array[m_touched[i]];
+                            dest[m_touched[i]] = sum > 255 ? 255 : sum;
+                        }
+                        return;
+                    }
+                }
+
+                coverage_add_saturating(dest, m_bb_array, SIZE);
+            }
+
+            // Calls func(index, count) for each non zero entry of the map. With dirty tracking only the logged entries are visited (in the order they were touched), otherwise the whole map is scanned.
+            template<typename FUNC>
+            void for_each_entry(FUNC func) const {
+                if constexpr(DIRTY_TRACKING){
+                    if(!is_log_overflowed()){
+                        for(size_t i = 0; i < m_touched_count; i++) func((size_t)m_touched[i], m_bb_array[m_touched[i]]);
+                        return;
+                    }
+                }
+
+                for(size_t i = 0; i < SIZE; i++){
+                    if(m_bb_array[i] != 0) func(i, m_bb_array[i]);
+                }
+            }
+
+            // Calculates the same hash as coverage_hash, but only visits the touched entries with dirty tracking.
+            uint64_t hash() const {
+                uint64_t hash = 0;
+                for_each_entry([&hash](size_t index, uint8_t count){
+                    hash += coverage_entry_hash(index, coverage_bucket(count));
+                });
+                return hash;
+            }
+
+            // Same as coverage_update_seen, but only visits the touched entries with dirty tracking.
+            bool update_seen(uint8_t* seen) const {
+                bool new_coverage = false;
+                for_each_entry([seen, &new_coverage](size_t index, uint8_t count){
+                    uint8_t bucket = coverage_bucket(count);
+                    if(bucket & ~seen[index]){
+                        seen[index] |= bucket;
+                        new_coverage = true;
+                    }
+                });
+                return new_coverage;
+            }
+
+            // Same as coverage_update_seen_shared, but only visits the touched entries with dirty tracking.
+            bool update_seen_shared(uint8_t* seen) const {
+                uint64_t* seen_words = reinterpret_cast<uint64_t*>(seen);
+                bool new_coverage = false;
+                for_each_entry([seen_words, &new_coverage](size_t index, uint8_t count){
+                    uint64_t buckets = (uint64_t)coverage_bucket(count) << coverage_word_shift(index);
+                    new_coverage |= coverage_set_seen_word(&seen_words[index / 8], buckets);
+                });
+                return new_coverage;
+            }
+
+            // Returns the number of touched (non zero) entries, if they are known from the log. Otherwise returns SIZE.
+            size_t touched_count() const {
+                if constexpr(DIRTY_TRACKING){
+                    if(!is_log_overflowed()) return m_touched_count;
+                }
+
+                return SIZE;
+            }
+
+            // Returns the number of entries that were hit the first time since the last reset, also beyond the capacity of the log. Always 0 without dirty tracking.
+            size_t hit_entry_count() const {
+                return DIRTY_TRACKING ? m_touched_count : 0;
+            }
+
+            // Getter for the raw counter array.
+            const uint8_t* data() const {
+                return m_bb_array;
+            }
+
+        private:
+
+            // Checks if more entries were touched than the log can hold.
+            bool is_log_overflowed() const {
+                return m_touched_count > LOG_CAPACITY;
+            }
+
+            // Array of hit counters.
+            alignas(64) uint8_t m_bb_array[SIZE];
+
+            // Log of the touched indices and the number of touched entries. The last slot is a scratch slot that is written by every hit once the log is full.
+            uint32_t m_touched[DIRTY_TRACKING ? LOG_CAPACITY + 1 : 1];
+            size_t m_touched_count = 0;
+    };
+
+    // Coverage map used by the testing_receiver.
+    using coverage_map = basic_coverage_map<MAP_SIZE, COVERAGE_DIRTY_TRACKING>;
+}
+
+#endif
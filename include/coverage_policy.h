@@ -0,0 +1,276 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TESTING_COVERAGE_POLICY_H
+#define TESTING_COVERAGE_POLICY_H
+
+#include <time.h>
+
+#include "coverage_map.h"
+
+// Number of blocks between two clock reads in the time based coverage sampling mode.
+#define COVERAGE_SAMPLE_CLOCK_STRIDE 64
+
+// Coverage policy of the trackers of the testing_receiver (hit_block), one of the policies below, for example block_coverage or ngram_edge_coverage<4>. The library and the VP must be compiled with the same definition.
+#ifndef COVERAGE_POLICY
+#define COVERAGE_POLICY edge_coverage
+#endif
+
+namespace testing{
+
+    // Coverage policies define which map entry is hit when a block is executed. They are used as template parameter of the coverage_tracker, so there is no runtime dispatch in the hot path. A policy must provide next_index(block_id), on_call(call_site_id), on_return() and reset(). The block IDs are the pre-hashed IDs of testing_receiver::register_block.
+
+    // Plain block coverage. Every block has its own map entry. This is the cheapest policy.
+    struct block_coverage{
+
+        inline uint32_t next_index(uint32_t block_id){
+            return block_id;
+        }
+
+        inline void on_call(uint32_t){}
+
+        inline void on_return(){}
+
+        void reset(){}
+    };
+
+    // AFL style edge coverage. The map entry is determined by the previous and the current block.
+    struct edge_coverage{
+
+        inline uint32_t next_index(uint32_t block_id){
+            uint32_t index = block_id ^ m_prev_bb_loc;
+            m_prev_bb_loc = block_id >> 1;
+            return index;
+        }
+
+        inline void on_call(uint32_t){}
+
+        inline void on_return(){}
+
+        void reset(){
+            m_prev_bb_loc = 0;
+        }
+
+        // Shifted ID of the previous block.
+        uint32_t m_prev_bb_loc = 0;
+    };
+
+    // N-gram edge coverage. The map entry is determined by the last N-1 blocks and the current block. Older blocks are shifted further, so the order of the blocks matters.
+    template<size_t N>
+    struct ngram_edge_coverage{
+
+        static_assert(N >= 2 && N <= 16, "N-gram coverage requires 2 <= N <= 16.");
+
+        inline uint32_t next_index(uint32_t block_id){
+            uint32_t index = block_id;
+            for(size_t i = 0; i < N - 1; i++) index ^= m_prev_bb_locs[i] >> (i + 1);
+
+            for(size_t i = N - 2; i > 0; i--) m_prev_bb_locs[i] = m_prev_bb_locs[i - 1];
+            m_prev_bb_locs[0] = block_id;
+
+            return index;
+        }
+
+        inline void on_call(uint32_t){}
+
+        inline void on_return(){}
+
+        void reset(){
+            for(size_t i = 0; i < N - 1; i++) m_prev_bb_locs[i] = 0;
+        }
+
+        // IDs of the last N-1 blocks, the most recent first.
+        uint32_t m_prev_bb_locs[N - 1] = {};
+    };
+
+    // Call-context sensitive edge coverage. The edge is combined with a hash of the current call stack, so the same edge reached via different callers hits different map entries. The VP must call on_call with the ID of the call site (for example register_block of the calling block) and on_return when a function returns.
+    struct call_context_edge_coverage{
+
+        // Maximum tracked call depth. Deeper calls keep the context of the deepest tracked call.
+        static constexpr size_t MAX_DEPTH = 64;
+
+        inline uint32_t next_index(uint32_t block_id){
+            uint32_t index = (block_id ^ m_prev_bb_loc ^ m_context) & (MAP_SIZE - 1);
+            m_prev_bb_loc = block_id >> 1;
+            return index;
+        }
+
+        inline void on_call(uint32_t call_site_id){
+            if(m_depth < MAX_DEPTH) m_context_stack[m_depth] = m_context;
+            m_depth++;
+            m_context ^= call_site_id;
+        }
+
+        inline void on_return(){
+            if(m_depth == 0) return;
+            m_depth--;
+            if(m_depth < MAX_DEPTH) m_context = m_context_stack[m_depth];
+        }
+
+        void reset(){
+            m_prev_bb_loc = 0;
+            m_context = 0;
+            m_depth = 0;
+        }
+
+        // Shifted ID of the previous block.
+        uint32_t m_prev_bb_loc = 0;
+
+        // Hash of the current call stack.
+        uint32_t m_context = 0;
+
+        // Saved contexts of the callers and the current call depth.
+        uint32_t m_context_stack[MAX_DEPTH];
+        size_t m_depth = 0;
+    };
+
+    // Sampling modes of the coverage_tracker. With SAMPLE_ALL every block is recorded. With SAMPLE_BLOCKS on average every Nth block is recorded, the distance between two samples is jittered by a seeded pseudo random generator, to not be aliased with loops of the target. With SAMPLE_TIME at most one block per host time interval is recorded. The policy state (for example the previous block) is updated for every block in all modes, so recorded edges are real edges and the map format stays the same.
+    enum coverage_sampling{
+        SAMPLE_ALL, SAMPLE_BLOCKS, SAMPLE_TIME
+    };
+
+    // Records executed blocks into a coverage map according to the POLICY. All trackers writing to the same map share the same export commands (GET_CODE_COVERAGE, GET_CODE_COVERAGE_SHM), so the VP can choose the cheapest policy that still gives useful feedback for a target.
+    template<typename POLICY, typename MAP = coverage_map>
+    class coverage_tracker{
+
+        public:
+
+            // Creates a tracker that writes to the given map.
+            coverage_tracker(MAP &map):m_map(&map){};
+
+            // Records the execution of a block by its ID from testing_receiver::register_block and counts it. Without sampling (the default) only the mode is checked, the countdown is not touched.
+            inline void hit_block(uint32_t block_id){
+                m_block_count++;
+                uint32_t index = m_policy.next_index(block_id);
+
+                if(__builtin_expect(m_sampling != SAMPLE_ALL, 0)){
+                    if(--m_sample_countdown == 0) sample(index);
+                    return;
+                }
+
+                m_map->hit(index);
+            }
+
+            // Sets the sampling mode. The period is the average number of blocks between two samples for SAMPLE_BLOCKS and the minimum host time in nanoseconds between two samples for SAMPLE_TIME. The seed makes the block sampling deterministic, it is applied again on every reset.
+            void configure_sampling(coverage_sampling sampling, uint64_t period, uint32_t seed){
+                m_sampling = sampling;
+                m_sample_period = period == 0 ? 1 : period;
+                m_sample_seed = seed == 0 ? 0x9E3779B9 : seed;
+                reset_sampling();
+            }
+
+            // Notifies the policy about a function call from the given call site.
+            inline void on_call(uint32_t call_site_id){
+                m_policy.on_call(call_site_id);
+            }
+
+            // Notifies the policy about a function return.
+            inline void on_return(){
+                m_policy.on_return();
+            }
+
+            // Resets the state of the policy (previous blocks, call context), the sampling and the block count, for example at the start of a run.
+            void reset(){
+                m_policy.reset();
+                reset_sampling();
+                m_block_count = 0;
+            }
+
+            // Getter for the number of executed blocks since the last reset, including the blocks that were not sampled.
+            uint64_t get_block_count() const {
+                return m_block_count;
+            }
+
+            // Getter for the coverage map.
+            MAP& get_map(){
+                return *m_map;
+            }
+
+        private:
+
+            // Slow path of hit_block for the sampling modes, called when the countdown reached zero.
+            void sample(uint32_t index){
+                if(m_sampling == SAMPLE_BLOCKS){
+                    m_map->hit(index);
+                    m_sample_countdown = next_block_distance();
+                    return;
+                }
+
+                // Time based sampling only reads the clock every COVERAGE_SAMPLE_CLOCK_STRIDE blocks.
+                m_sample_countdown = COVERAGE_SAMPLE_CLOCK_STRIDE;
+
+                struct timespec now;
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                uint64_t now_ns = (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+
+                if(now_ns >= m_next_sample_time){
+                    m_map->hit(index);
+                    m_next_sample_time = now_ns + m_sample_period;
+                }
+            }
+
+            // Restarts the sampling sequence from the seed.
+            void reset_sampling(){
+                m_random_state = m_sample_seed;
+                m_next_sample_time = 0;
+
+                if(m_sampling == SAMPLE_BLOCKS){
+                    m_sample_countdown = next_block_distance();
+                }else{
+                    m_sample_countdown = 1;
+                }
+            }
+
+            // Returns the jittered distance to the next sampled block, uniform in [period/2, period*3/2).
+            uint64_t next_block_distance(){
+                // xorshift32
+                m_random_state ^= m_random_state << 13;
+                m_random_state ^= m_random_state >> 17;
+                m_random_state ^= m_random_state << 5;
+
+                uint64_t distance = m_sample_period / 2 + m_random_state % m_sample_period;
+                return distance == 0 ? 1 : distance;
+            }
+
+            // Map that is written to.
+            MAP* m_map;
+
+            // Number of executed blocks since the last reset.
+            uint64_t m_block_count = 0;
+
+            // Sampling mode, in front of the policy so hit_block reads it from the same cache line as the map and the block count.
+            coverage_sampling m_sampling = SAMPLE_ALL;
+
+            // State of the policy.
+            POLICY m_policy;
+
+            // Number of blocks until the next sampled block is recorded (or the clock is checked).
+            uint64_t m_sample_countdown = 1;
+
+            // Sampling configuration.
+            uint64_t m_sample_period = 1;
+            uint32_t m_sample_seed = 0x9E3779B9;
+
+            // State of the pseudo random generator and the host time of the next sample.
+            uint32_t m_random_state = 0x9E3779B9;
+            uint64_t m_next_sample_time = 0;
+    };
+}
+
+#endif
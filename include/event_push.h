@@ -0,0 +1,100 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TESTING_EVENT_PUSH_H
+#define TESTING_EVENT_PUSH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "shm_ring.h"
+#include "types.h"
+
+// Maximum number of bytes of the additional event data that are copied into a pushed event.
+#define EVENT_PUSH_MAX_DATA 40
+
+// Size of a pushed event without the copied data.
+#define EVENT_PUSH_HEADER_SIZE 24
+
+// Value of the wakeup offset of ENABLE_EVENT_PUSH if no wakeup word is used.
+#define EVENT_PUSH_NO_WAKEUP 0xFFFFFFFF
+
+namespace testing{
+
+    // Notification of an event, pushed as one record of an shm_ring (host byte order). The record only contains the copied data, so it is EVENT_PUSH_HEADER_SIZE plus up to EVENT_PUSH_MAX_DATA bytes long.
+    struct pushed_event{
+        // Number of the event since the channel was attached. A gap in the sequence tells the client that events were dropped.
+        uint64_t sequence;
+
+        // Simulated time of the event in picoseconds, 0 if the VP does not report it.
+        uint64_t timestamp;
+
+        // Type of the event (event_type).
+        uint8_t event;
+        uint8_t reserved[3];
+
+        // Length of the additional event data, of which the first EVENT_PUSH_MAX_DATA bytes are copied.
+        uint32_t data_length;
+        char data[EVENT_PUSH_MAX_DATA];
+    };
+
+    static_assert(sizeof(pushed_event) == EVENT_PUSH_HEADER_SIZE + EVENT_PUSH_MAX_DATA, "Unexpected pushed event size.");
+
+    // Pushes event notifications to the client through a ring in shared memory (initialized by the client), so the client learns about events without a CONTINUE round trip. Events are never waited for: if the ring is full or another thread is pushing at the same time (for example a signal handler calling notify_VP_ERROR_event), the event is dropped and leaves a gap in the sequence. After every push the optional wakeup word is incremented and waiters on it are woken up with a futex, so the client can block instead of polling.
+    class event_push_channel{
+        public:
+
+            // Uses the ring at the given memory (initialized by the client). Only events whose bit (1 << event_type) is set in event_mask are pushed. The wakeup word may be nullptr.
+            bool attach(char* memory, size_t size, uint32_t event_mask, std::atomic<uint32_t>* wakeup);
+
+            // Stops pushing and waits for a push in progress, so the memory of the ring can be unmapped afterwards. Must not be called from a thread that may interrupt a push (signal handler).
+            void detach();
+
+            // Checks if events of the given type are pushed.
+            inline bool is_pushed(event_type type) const {
+                return m_attached.load(std::memory_order_relaxed) && (m_event_mask & (1u << type));
+            }
+
+            // Pushes an event with the first EVENT_PUSH_MAX_DATA bytes of its data. Returns false if the event was dropped.
+            bool push(event_type type, const char* data, uint32_t data_length, uint64_t timestamp);
+
+            // Getter for the number of dropped events.
+            uint64_t get_dropped() const;
+
+            // Waits until the wakeup word differs from last_value or the timeout (in milliseconds, 0 waits forever) expired (client side). Returns the current value of the word.
+            static uint32_t wait(std::atomic<uint32_t>* wakeup, uint32_t last_value, uint32_t timeout_ms);
+
+        private:
+
+            shm_ring m_ring;
+            std::atomic<uint32_t>* m_wakeup = nullptr;
+            uint32_t m_event_mask = 0;
+            std::atomic<bool> m_attached{false};
+
+            // Sequence number of the next event and the number of dropped events.
+            std::atomic<uint64_t> m_sequence{0};
+            std::atomic<uint64_t> m_dropped{0};
+
+            // Set while a thread pushes, the ring has a single producer.
+            std::atomic_flag m_pushing = ATOMIC_FLAG_INIT;
+    };
+}
+
+#endif
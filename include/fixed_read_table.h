@@ -0,0 +1,112 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TESTING_FIXED_READ_TABLE_H
+#define TESTING_FIXED_READ_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Number of bits of the address filter of the fixed read table.
+#define FIXED_READ_FILTER_BITS 4096
+
+namespace testing{
+
+    // Table of fixed reads (see SET_FIXED_READ) for the VP's bus hook. Every entry has an address, a width of 1 to 8 bytes and a value. A read is first checked against a bit filter of the entry addresses, so most reads without a fixed value cost one bit test. The entries are stored in an open addressing hash table with separate arrays for addresses, values and widths (structure of arrays), so a hit usually needs one probe.
+    class fixed_read_table{
+        public:
+
+            // Creates an empty table.
+            fixed_read_table();
+
+            // Sets the fixed value of width bytes (1 to 8) at the address, the value bytes are in memory order. An existing entry of the address is replaced.
+            bool set(uint64_t address, const char* value, size_t width);
+
+            // Removes all entries.
+            void clear();
+
+            // Checks if a fixed read is set for the address and copies its value to dest. If the read is longer than the entry, the remaining bytes are zero.
+            inline bool read(uint64_t address, char* dest, size_t length) const {
+                uint64_t filter_bit = filter_index(address);
+                if(!(m_filter[filter_bit / 64] & (1ULL << (filter_bit % 64)))) return false;
+
+                size_t mask = m_widths.size() - 1;
+                size_t slot = slot_of(address);
+                while(m_widths[slot] != 0){
+                    if(m_addresses[slot] == address){
+                        copy_value(m_values[slot], dest, length);
+                        return true;
+                    }
+                    slot = (slot + 1) & mask;
+                }
+
+                return false;
+            }
+
+            // Checks if the table has no entries.
+            inline bool empty() const {
+                return m_count == 0;
+            }
+
+            // Getter for the number of entries.
+            size_t size() const;
+
+        private:
+
+            // Bit of the address in the filter. Neighbouring registers (4 byte aligned) get different bits.
+            static inline uint64_t filter_index(uint64_t address){
+                return ((address >> 2) ^ (address >> 14)) & (FIXED_READ_FILTER_BITS - 1);
+            }
+
+            // Slot of the address in the hash table.
+            inline size_t slot_of(uint64_t address) const {
+                return (size_t)((address * 0x9E3779B97F4A7C15ULL) >> 32) & (m_widths.size() - 1);
+            }
+
+            // Copies length bytes of a zero extended value, with fixed size copies for the common register widths.
+            static inline void copy_value(uint64_t value, char* dest, size_t length){
+                switch(length){
+                    case 1: *dest = (char)value; break;
+                    case 2: memcpy(dest, &value, 2); break;
+                    case 4: memcpy(dest, &value, 4); break;
+                    case 8: memcpy(dest, &value, 8); break;
+                    default:
+                        memcpy(dest, &value, length < 8 ? length : 8);
+                        if(length > 8) memset(dest + 8, 0, length - 8);
+                        break;
+                }
+            }
+
+            // Inserts an entry without checking the load of the table.
+            void insert(uint64_t address, uint64_t value, uint8_t width);
+
+            // Hash table slots, a width of 0 marks an empty slot. The size is a power of two and at most half of the slots are used. The values are zero extended and in memory order.
+            std::vector<uint64_t> m_addresses;
+            std::vector<uint64_t> m_values;
+            std::vector<uint8_t> m_widths;
+            size_t m_count = 0;
+
+            // Bit filter of all entry addresses.
+            uint64_t m_filter[FIXED_READ_FILTER_BITS / 64] = {};
+    };
+}
+
+#endif
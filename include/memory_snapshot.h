@@ -0,0 +1,143 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TESTING_MEMORY_SNAPSHOT_H
+#define TESTING_MEMORY_SNAPSHOT_H
+
+#include <signal.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Maximum number of regions that can be tracked with write protection by all snapshots of the process.
+#define SNAPSHOT_MAX_TRACKED_REGIONS 64
+
+namespace testing{
+
+    // Methods for tracking the pages that were written after a snapshot was created.
+    // WRITE_PROTECT_TRACKING: The regions are write protected and the first write to a page is caught by a SIGSEGV handler, which records the page and unprotects it. The restore cost only depends on the written pages. Writes of the kernel (for example read() into guest memory) fail with EFAULT instead of being caught, so the VP must not do this while tracking.
+    // SOFT_DIRTY_TRACKING: Uses the soft-dirty bits of the Linux kernel (/proc/self/clear_refs and /proc/self/pagemap). No signal handler is required, but the page map of all registered pages is read on every restore and the soft-dirty bits of the whole process are cleared.
+    enum dirty_page_tracking{
+        WRITE_PROTECT_TRACKING, SOFT_DIRTY_TRACKING
+    };
+
+    // Snapshot of registered guest memory regions. After create, the pages that are written are tracked and restore copies back only these pages, so the reset cost scales with the pages a run actually wrote and not with the memory size of the VP.
+    class memory_snapshot{
+        public:
+
+            // Creates an empty snapshot with the given dirty page tracking method.
+            memory_snapshot(dirty_page_tracking tracking = WRITE_PROTECT_TRACKING);
+
+            // Stops the tracking and unprotects all regions.
+            ~memory_snapshot();
+
+            memory_snapshot(const memory_snapshot&) = delete;
+            memory_snapshot& operator=(const memory_snapshot&) = delete;
+
+            // Sets the dirty page tracking method. Must be called before create.
+            bool set_tracking(dirty_page_tracking tracking);
+
+            // Registers a guest memory region. The region must be readable and writable host memory and is extended to page boundaries. Must be called before create.
+            bool add_region(void* start, size_t size);
+
+            // Copies all registered regions and starts tracking written pages. An existing snapshot is replaced.
+            bool create();
+
+            // Copies the pages that were written since create (or the last restore) back from the snapshot and restarts the tracking. Must be called while the VP does not execute.
+            bool restore();
+
+            // Stops the tracking and frees the copies. The registered regions are kept.
+            void discard();
+
+            // Checks if regions were registered.
+            bool has_regions() const;
+
+            // Checks if a snapshot was created.
+            bool has_snapshot() const;
+
+            // Getter for the number of pages copied back by the last restore.
+            size_t get_restored_page_count() const;
+
+        private:
+
+            // Registered region with its copy and the pages written since the last create / restore.
+            struct region{
+                char* start;
+                size_t size;
+                size_t page_count;
+                std::vector<char> copy;
+
+                // Written pages, filled by the signal handler.
+                std::unique_ptr<uint32_t[]> dirty_pages;
+                size_t dirty_count = 0;
+            };
+
+            // SIGSEGV handler for WRITE_PROTECT_TRACKING.
+            static void handle_write_fault(int signal, siginfo_t* info, void* context);
+
+            // Installs the SIGSEGV handler once.
+            static bool install_fault_handler();
+
+            // Adds / removes a region from the regions seen by the signal handler.
+            static bool register_tracked_region(region* tracked_region);
+            static void unregister_tracked_region(region* tracked_region);
+
+            // Write protects all pages of a region.
+            bool protect_region(region &tracked_region);
+
+            // Restores the written pages of a region with write protection tracking.
+            bool restore_write_protected(region &tracked_region);
+
+            // Restores the written pages of a region with soft-dirty tracking.
+            bool restore_soft_dirty(region &tracked_region);
+
+            // Clears the soft-dirty bits of the process.
+            bool clear_soft_dirty();
+
+            // Checks if the kernel sets soft-dirty bits (CONFIG_MEM_SOFT_DIRTY), by writing a private page.
+            bool probe_soft_dirty();
+
+            // Used tracking method.
+            dirty_page_tracking m_tracking;
+
+            // Registered regions.
+            std::vector<std::unique_ptr<region>> m_regions;
+
+            // Indicates that a snapshot was created.
+            bool m_created = false;
+
+            // Number of pages restored by the last restore.
+            size_t m_restored_pages = 0;
+
+            // File descriptor of /proc/self/pagemap for SOFT_DIRTY_TRACKING.
+            int m_pagemap_fd = -1;
+
+            // Regions of all snapshots that are write protected, read by the signal handler.
+            static std::atomic<region*> s_tracked_regions[SNAPSHOT_MAX_TRACKED_REGIONS];
+
+            // Handler that was installed before the SIGSEGV handler, faults outside of tracked regions are forwarded to it.
+            static struct sigaction s_previous_handler;
+            static bool s_handler_installed;
+    };
+}
+
+#endif
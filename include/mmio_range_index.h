@@ -0,0 +1,95 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TESTING_MMIO_RANGE_INDEX_H
+#define TESTING_MMIO_RANGE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace testing{
+
+    // Modes of a tracked MMIO range (CPU perspective), same values as ENABLE_MMIO_TRACKING.
+    enum mmio_tracking_mode{
+        TRACK_READ_WRITE, TRACK_READ, TRACK_WRITE
+    };
+
+    // Index of tracked MMIO ranges, each with an ID and a mode, for the VP's bus hook. The ranges are kept in sorted arrays (structure of arrays) and looked up with a branchless binary search. Addresses outside of all ranges, the majority of the bus traffic, are rejected with two compares.
+    class mmio_range_index{
+        public:
+
+            // Adds a range from start to end address (both inclusive). Fails if the ID is already used or the range overlaps another range.
+            bool add(uint32_t id, uint64_t start_address, uint64_t end_address, mmio_tracking_mode mode);
+
+            // Removes the range with the given ID. Returns false if it does not exist.
+            bool remove(uint32_t id);
+
+            // Removes all ranges.
+            void clear();
+
+            // Checks if the access is tracked and writes the ID of the range to id.
+            inline bool lookup(uint64_t address, bool write, uint32_t &id) const {
+                if(address < m_min_address || address > m_max_address) return false;
+
+                // Index of the last range that starts at or before the address.
+                const uint64_t* base = m_starts.data();
+                size_t count = m_starts.size();
+                while(count > 1){
+                    size_t half = count / 2;
+                    base = base[half] <= address ? base + half : base;
+                    count -= half;
+                }
+
+                size_t index = base - m_starts.data();
+                if(address > m_ends[index]) return false;
+
+                mmio_tracking_mode mode = m_modes[index];
+                if(mode != TRACK_READ_WRITE && (mode == TRACK_WRITE) != write) return false;
+
+                id = m_ids[index];
+                return true;
+            }
+
+            // Checks if no range is tracked.
+            inline bool empty() const {
+                return m_starts.empty();
+            }
+
+            // Getter for the number of ranges.
+            size_t size() const;
+
+        private:
+
+            // Updates the bounds of all ranges.
+            void update_bounds();
+
+            // Ranges sorted by start address.
+            std::vector<uint64_t> m_starts;
+            std::vector<uint64_t> m_ends;
+            std::vector<uint32_t> m_ids;
+            std::vector<mmio_tracking_mode> m_modes;
+
+            // Bounds of all ranges, empty bounds (min > max) if no range is tracked.
+            uint64_t m_min_address = UINT64_MAX;
+            uint64_t m_max_address = 0;
+    };
+}
+
+#endif
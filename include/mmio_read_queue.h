@@ -0,0 +1,132 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TESTING_MMIO_READ_QUEUE_H
+#define TESTING_MMIO_READ_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace testing{
+
+    // MMIO read queue (see ADD_TO_MMIO_READ_QUEUE), which a VP can use for the lookup on every intercepted bus read. Every address has one contiguous byte queue, the addresses are stored in a flat open addressing table. A read takes as many bytes as requested and available, if less bytes are available than requested the VP should trigger an MMIO_READ event for the remaining bytes.
+    class mmio_read_queue{
+        public:
+
+            // Creates an empty queue with space for the given number of addresses (rounded up to a power of two).
+            mmio_read_queue(size_t address_capacity = 16);
+
+            // Appends a copy of the data to the queue of the address.
+            void push(uint64_t address, const char* data, size_t length);
+
+            // Appends the data to the queue of the address without copying it, if the queue of the address is empty. The data must stay valid until it was read or the queue is cleared, for example the request data of DO_RUN during handle_do_run. Otherwise the data is copied.
+            void push_view(uint64_t address, const char* data, size_t length);
+
+            // Reads up to length bytes of the queue of the address into dest. Returns the number of read bytes, which is smaller than length if the queue did not contain enough data.
+            inline size_t read(uint64_t address, char* dest, size_t length){
+                if(m_queued_bytes == 0) return 0;
+
+                entry* queue = find(address);
+                if(queue == nullptr) return 0;
+
+                size_t count = queue->tail - queue->head;
+                if(count > length) count = length;
+
+                // Fixed size copies for the common register widths, to avoid a memcpy call.
+                const char* source = queue->data + queue->head;
+                switch(count){
+                    case 1: *dest = *source; break;
+                    case 2: memcpy(dest, source, 2); break;
+                    case 4: memcpy(dest, source, 4); break;
+                    case 8: memcpy(dest, source, 8); break;
+                    default: memcpy(dest, source, count); break;
+                }
+                queue->head += count;
+                m_queued_bytes -= count;
+
+                // An empty queue starts at the beginning of its own buffer again (and forgets a view).
+                if(queue->head == queue->tail){
+                    queue->head = 0;
+                    queue->tail = 0;
+                    queue->data = queue->buffer.data();
+                }
+
+                return count;
+            }
+
+            // Getter for the number of queued bytes of the address.
+            size_t available(uint64_t address) const;
+
+            // Checks if no data is queued for any address. Then the VP can skip the lookup.
+            inline bool empty() const {
+                return m_queued_bytes == 0;
+            }
+
+            // Removes the queued data of the address.
+            void clear(uint64_t address);
+
+            // Removes the queued data of all addresses. The buffers are kept for the next run.
+            void clear();
+
+        private:
+
+            // Queue of one address. The queued bytes are data[head, tail), data is either the own buffer or a view of external data.
+            struct entry{
+                uint64_t address = 0;
+                bool used = false;
+                const char* data = nullptr;
+                size_t head = 0;
+                size_t tail = 0;
+                std::vector<char> buffer;
+            };
+
+            // Slot of the address in the table (linear probing).
+            inline size_t slot_of(uint64_t address) const {
+                uint64_t hash = address * 0x9E3779B97F4A7C15ULL;
+                return (size_t)(hash >> 32) & (m_entries.size() - 1);
+            }
+
+            // Finds the queue of an address, nullptr if the address has no queue.
+            inline entry* find(uint64_t address){
+                size_t slot = slot_of(address);
+                while(m_entries[slot].used){
+                    if(m_entries[slot].address == address) return &m_entries[slot];
+                    slot = (slot + 1) & (m_entries.size() - 1);
+                }
+                return nullptr;
+            }
+
+            // Finds or creates the queue of an address.
+            entry& find_or_insert(uint64_t address);
+
+            // Copies a view into the own buffer and moves the queued bytes to the start of the buffer, so new data can be appended.
+            void make_owned(entry &queue, size_t additional_length);
+
+            // Table of queues, the size is a power of two and at most half of the slots are used.
+            std::vector<entry> m_entries;
+            size_t m_used_entries = 0;
+
+            // Number of queued bytes of all addresses.
+            size_t m_queued_bytes = 0;
+    };
+}
+
+#endif
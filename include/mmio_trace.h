@@ -0,0 +1,159 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TESTING_MMIO_TRACE_H
+#define TESTING_MMIO_TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "shm_ring.h"
+
+// Size of the header of a fixed record trace ring in front of the records.
+#define MMIO_TRACE_HEADER_SIZE 192
+
+// Number of records of one block of the delta encoding. Every block starts with a keyframe, so blocks can be decoded independently.
+#define MMIO_TRACE_BLOCK_RECORDS 64
+
+// Maximum size of one delta encoded record (flags, range ID, address, timestamp, value).
+#define MMIO_TRACE_MAX_DELTA_RECORD 36
+
+namespace testing{
+
+    // One traced MMIO access (32 bytes, host byte order), as stored in the fixed record trace ring.
+    struct mmio_trace_record{
+        // Simulated time of the access in picoseconds.
+        uint64_t timestamp;
+        uint64_t address;
+
+        // Value of the access, zero extended, in memory order.
+        uint64_t value;
+
+        // Width of the access in bytes (1 to 8) and the direction (0: read, 1: write).
+        uint8_t width;
+        uint8_t write;
+        uint16_t reserved;
+
+        // ID of the tracked range (see ADD_MMIO_TRACKING_RANGE), 0 for the range of ENABLE_MMIO_TRACKING.
+        uint32_t range_id;
+    };
+
+    static_assert(sizeof(mmio_trace_record) == 32, "Unexpected trace record size.");
+
+    // What happens when the trace ring is full. TRACE_OVERWRITE drops the oldest record, TRACE_DROP drops the new record and TRACE_BACKPRESSURE waits until the client made space (the simulation only waits when the ring is full).
+    enum mmio_trace_policy{
+        TRACE_OVERWRITE, TRACE_DROP, TRACE_BACKPRESSURE
+    };
+
+    // Encoding of the trace. TRACE_FIXED writes mmio_trace_record entries into a mmio_trace_ring. TRACE_DELTA writes blocks of delta encoded records into a shm_ring (see mmio_trace_writer), which is much smaller for bursty writes to the same registers. TRACE_OVERWRITE is not supported for TRACE_DELTA.
+    enum mmio_trace_encoding{
+        TRACE_FIXED, TRACE_DELTA
+    };
+
+    // Header of the fixed record trace ring in shared memory. The positions are free running record counters.
+    // Layout: Byte 0-7: Head (written by the VP), Byte 64-71: Tail (written by the client, and by the VP for TRACE_OVERWRITE), Byte 128-135: Capacity in records (power of two), Byte 136-143: Number of dropped records.
+    struct mmio_trace_header{
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<uint64_t> tail;
+        alignas(64) uint64_t capacity;
+        std::atomic<uint64_t> dropped;
+    };
+
+    static_assert(sizeof(mmio_trace_header) == MMIO_TRACE_HEADER_SIZE, "Unexpected trace header size.");
+
+    // Ring of fixed size trace records in shared memory. With TRACE_OVERWRITE the VP advances the tail itself, so the client must remove records with a compare and swap on the tail (as pop does) and discard a record if that fails, because it may have been overwritten while it was copied.
+    class mmio_trace_ring{
+        public:
+
+            // Initializes a ring in the given memory (done by the client). The capacity is the largest power of two of records that fits after the header.
+            bool init(char* memory, size_t size);
+
+            // Uses a ring that was initialized by the client.
+            bool attach(char* memory, size_t size);
+
+            // Appends a record according to the policy. Returns false if the record was dropped.
+            bool push(const mmio_trace_record &record, mmio_trace_policy policy);
+
+            // Removes the oldest record (client side). Returns false if the ring is empty.
+            bool pop(mmio_trace_record &record);
+
+            // Getter for the number of dropped records.
+            uint64_t get_dropped() const;
+
+        private:
+
+            // Header and records of the ring.
+            mmio_trace_header* m_header = nullptr;
+            mmio_trace_record* m_records = nullptr;
+    };
+
+    // Writes traced MMIO accesses with the configured encoding and policy. For TRACE_DELTA the records are collected into blocks of MMIO_TRACE_BLOCK_RECORDS, each block is one record of the shm_ring and starts with a keyframe (the first record is encoded against zero). Encoded record: flags (bit 0: write, bit 1-3: width - 1, bit 4: range ID follows), range ID (varint, if flagged), address difference (zigzag varint), timestamp difference (zigzag varint), value (varint).
+    class mmio_trace_writer{
+        public:
+
+            // Uses the ring at the given memory (initialized by the client) with the encoding and policy.
+            bool attach(char* memory, size_t size, mmio_trace_encoding encoding, mmio_trace_policy policy);
+
+            // Stops writing, an unfinished delta block is flushed.
+            void detach();
+
+            // Checks if the writer is attached to a ring.
+            inline bool is_attached() const {
+                return m_attached;
+            }
+
+            // Appends an access to the trace.
+            void append(const mmio_trace_record &record);
+
+            // Writes an unfinished delta block to the ring, for example at the end of a run.
+            void flush();
+
+            // Getter for the number of delta blocks dropped with TRACE_DROP. Dropped fixed records are counted in the ring header.
+            uint64_t get_dropped_blocks() const;
+
+            // Decodes one delta block (one record of the shm_ring) and appends the records to records. Returns false if the block is malformed.
+            static bool decode_block(const char* block, size_t length, std::vector<mmio_trace_record> &records);
+
+        private:
+
+            // Appends the delta encoding of a record to the current block.
+            void encode(const mmio_trace_record &record);
+
+            // Configuration.
+            mmio_trace_encoding m_encoding = TRACE_FIXED;
+            mmio_trace_policy m_policy = TRACE_DROP;
+            bool m_attached = false;
+
+            // Rings of the encodings.
+            mmio_trace_ring m_fixed_ring;
+            shm_ring m_delta_ring;
+
+            // Current delta block, its number of records and the previous record of the block.
+            std::vector<char> m_block;
+            size_t m_block_records = 0;
+            mmio_trace_record m_previous = {};
+
+            // Number of dropped delta blocks.
+            uint64_t m_dropped_blocks = 0;
+    };
+}
+
+#endif
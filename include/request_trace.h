@@ -0,0 +1,138 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TESTING_REQUEST_TRACE_H
+#define TESTING_REQUEST_TRACE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "types.h"
+
+// Magic number at the start of a request trace file.
+#define REQUEST_TRACE_MAGIC "VPTITRC1"
+
+// Size of the header of a record in a request trace file.
+#define REQUEST_TRACE_RECORD_HEADER_SIZE 18
+
+// Buffer size of the trace file, records are written to the file when it is full.
+#define REQUEST_TRACE_BUFFER_SIZE (1 << 20)
+
+// After a response the buffered records are written to the file once they exceed this size or the last write is older than the interval, so a VP that is killed (SIGKILL) loses at most this part of its trace.
+#define REQUEST_TRACE_FLUSH_THRESHOLD (64 << 10)
+#define REQUEST_TRACE_FLUSH_INTERVAL_NS 100000000ULL
+
+namespace testing{
+
+    // Type of a record in a request trace.
+    enum request_trace_record_type{
+        TRACE_REQUEST, TRACE_RESPONSE
+    };
+
+    // Record of a request trace. For responses the data is only stored if the writer records response data, data_length is always the length of the original data.
+    struct request_trace_record{
+        request_trace_record_type type = TRACE_REQUEST;
+
+        // Command of a request or status of a response.
+        uint8_t code = 0;
+
+        // Time since the start of the recording in nanoseconds.
+        uint64_t timestamp = 0;
+
+        uint32_t data_length = 0;
+        std::vector<char> data;
+    };
+
+    // Writes the requests and responses of a testing_communication with timestamps into a binary trace file, which can be replayed with vpti-replay.
+    // File: magic (8 bytes), then the records. Record: Byte 0: Type, Byte 1: Command or status, Byte 2-9: Timestamp in ns, Byte 10-13: Data length, Byte 14-17: Stored data length, Byte 18-?: Stored data. All numbers big endian.
+    class request_trace_writer{
+        public:
+
+            request_trace_writer() = default;
+
+            // Closes the file.
+            ~request_trace_writer();
+
+            request_trace_writer(const request_trace_writer&) = delete;
+            request_trace_writer& operator=(const request_trace_writer&) = delete;
+
+            // Creates the trace file. Response data is only recorded with response_data, otherwise only the status and the length of responses.
+            bool open(const std::string &path, bool response_data);
+
+            // Writes the remaining records and closes the file.
+            void close();
+
+            // Checks if a trace file is open.
+            inline bool is_open() const {
+                return m_file != nullptr;
+            }
+
+            // Appends a request or a response with the current time. After a response the records are written to the file if enough data or time accumulated (see REQUEST_TRACE_FLUSH_THRESHOLD).
+            void write_request(const request &req);
+            void write_response(const response &res);
+
+            // Writes the buffered records to the file.
+            void flush();
+
+        private:
+
+            // Appends a record with the current time, which is returned.
+            uint64_t write_record(request_trace_record_type type, uint8_t code, const char* data, uint32_t data_length, uint32_t stored_length);
+
+            FILE* m_file = nullptr;
+            bool m_response_data = false;
+
+            // Start of the recording and time of the last write to the file on the monotonic clock in nanoseconds.
+            uint64_t m_start_time = 0;
+            uint64_t m_flush_time = 0;
+
+            // Bytes of records since the last write to the file.
+            size_t m_buffered = 0;
+    };
+
+    // Reads the records of a request trace file.
+    class request_trace_reader{
+        public:
+
+            request_trace_reader() = default;
+
+            // Closes the file.
+            ~request_trace_reader();
+
+            request_trace_reader(const request_trace_reader&) = delete;
+            request_trace_reader& operator=(const request_trace_reader&) = delete;
+
+            // Opens the trace file and checks the magic number.
+            bool open(const std::string &path);
+
+            // Closes the file.
+            void close();
+
+            // Reads the next record. Returns false at the end of the file or if the record is truncated.
+            bool next(request_trace_record &record);
+
+        private:
+
+            FILE* m_file = nullptr;
+    };
+}
+
+#endif
@@ -0,0 +1,147 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TESTING_SHARED_MEMORY_H
+#define TESTING_SHARED_MEMORY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/shm.h>
+
+// Size of the header of a POSIX shared memory input region in front of the input data.
+#define SHM_INPUT_HEADER_SIZE 64
+
+namespace testing{
+
+    // Attachment of a System V shared memory segment. The segment is detached when the object is destroyed.
+    class sysv_shm_segment{
+        public:
+
+            sysv_shm_segment() = default;
+
+            // Detaches the segment if attached.
+            ~sysv_shm_segment();
+
+            sysv_shm_segment(const sysv_shm_segment&) = delete;
+            sysv_shm_segment& operator=(const sysv_shm_segment&) = delete;
+
+            // Attaches the segment with the given ID and reads its size. Returns false on failure, errno is set accordingly.
+            bool attach(int shm_id, bool read_only);
+
+            // Detaches the segment. Returns false on failure.
+            bool detach();
+
+            // Checks if the range of length bytes starting at offset lies inside the segment.
+            bool contains(size_t offset, size_t length) const;
+
+            // Getter for the start of the segment, nullptr if not attached.
+            char* data() const;
+
+            // Getter for the size of the segment.
+            size_t size() const;
+
+        private:
+
+            // Start address and size of the attached segment.
+            char* m_data = nullptr;
+            size_t m_size = 0;
+    };
+
+    // Header of an input region (see DO_RUN_POSIX_SHM). The client writes the data and the length and then increments the sequence, so the VP knows the exact length without scanning the data and can detect that an input is used again. Host byte order.
+    // Layout: Byte 0-7: Sequence, Byte 8-15: Length, Byte 16-63: Reserved, Byte 64-?: Data.
+    struct shm_input_header{
+        std::atomic<uint64_t> sequence;
+        uint64_t length;
+        uint64_t reserved[6];
+    };
+
+    static_assert(sizeof(shm_input_header) == SHM_INPUT_HEADER_SIZE, "Unexpected input header size.");
+
+    // Mapping of a POSIX shared memory object (by its name, for shm_open) or of a file (by its path, for example /proc/<pid>/fd/<fd> of a memfd). The region is unmapped when the object is destroyed.
+    class posix_shm_region{
+        public:
+
+            posix_shm_region() = default;
+
+            // Unmaps the region if mapped.
+            ~posix_shm_region();
+
+            posix_shm_region(const posix_shm_region&) = delete;
+            posix_shm_region& operator=(const posix_shm_region&) = delete;
+
+            // Maps the shared memory object or file with the given name. Names starting with "/" and containing another "/" are opened as path, other names with shm_open. Returns false on failure, errno is set accordingly.
+            bool open(const std::string &name, bool read_only);
+
+            // Unmaps the region.
+            void close();
+
+            // Checks if the range of length bytes starting at offset lies inside the region.
+            bool contains(size_t offset, size_t length) const;
+
+            // Getter for the name of the mapped region, empty if not mapped.
+            const std::string& name() const;
+
+            // Getter for the start of the region, nullptr if not mapped.
+            char* data() const;
+
+            // Getter for the size of the region.
+            size_t size() const;
+
+        private:
+
+            // Name, start address and size of the mapped region.
+            std::string m_name;
+            char* m_data = nullptr;
+            size_t m_size = 0;
+    };
+
+    // Zero initialized anonymous shared mapping. It stays shared with forked child processes (see FORK_SERVER), so their writes are visible to the parent. The mapping is released when the object is destroyed.
+    class anonymous_shared_memory{
+        public:
+
+            anonymous_shared_memory() = default;
+
+            // Releases the mapping if allocated.
+            ~anonymous_shared_memory();
+
+            anonymous_shared_memory(const anonymous_shared_memory&) = delete;
+            anonymous_shared_memory& operator=(const anonymous_shared_memory&) = delete;
+
+            // Maps size zero initialized bytes. An existing mapping is released.
+            bool allocate(size_t size);
+
+            // Releases the mapping.
+            void release();
+
+            // Getter for the start of the mapping, nullptr if not allocated.
+            char* data() const;
+
+            // Getter for the size of the mapping.
+            size_t size() const;
+
+        private:
+
+            char* m_data = nullptr;
+            size_t m_size = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,209 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TESTING_SHM_RING_H
+#define TESTING_SHM_RING_H
+
+#include <sched.h>
+#include <time.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Size of the ring header in front of the ring data.
+#define SHM_RING_HEADER_SIZE 192
+
+// Length value of a padding record, which tells the consumer to continue at the start of the ring data.
+#define SHM_RING_PADDING 0xFFFFFFFF
+
+namespace testing{
+
+    // Result of shm_ring::front. A malformed record (its length exceeds the ring or the written data) can never be read, the consumer has to give up the ring.
+    enum shm_ring_front_result{
+        SHM_RING_EMPTY, SHM_RING_RECORD, SHM_RING_MALFORMED
+    };
+
+    // Header of a single producer, single consumer ring in shared memory. The positions are free running byte counters, the ring data (capacity bytes, a power of two) follows the header. Head and tail are on separate cache lines, so producer and consumer do not share a line. All values are in host byte order, producer and consumer run on the same host.
+    // Layout: Byte 0-7: Head (written by the producer), Byte 64-71: Tail (written by the consumer), Byte 128-135: Capacity, Byte 136-139: Stop flag.
+    struct shm_ring_header{
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<uint64_t> tail;
+        alignas(64) uint64_t capacity;
+        std::atomic<uint32_t> stop;
+    };
+
+    static_assert(sizeof(shm_ring_header) == SHM_RING_HEADER_SIZE, "Unexpected ring header size.");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "The ring requires lock free 64 bit atomics.");
+
+    // View of a ring in shared memory. Each record is a 4 byte length followed by the data, aligned to 8 bytes. A record never wraps around the end of the ring: if it does not fit, the producer writes a padding record and continues at the start, so the consumer can always use the data in place.
+    class shm_ring{
+        public:
+
+            // Initializes a ring in the given memory (done by the creator of the ring). The capacity is the largest power of two that fits after the header.
+            bool init(char* memory, size_t size){
+                if(memory == nullptr || size < SHM_RING_HEADER_SIZE + 64) return false;
+
+                size_t capacity = 64;
+                while(capacity * 2 <= size - SHM_RING_HEADER_SIZE) capacity *= 2;
+
+                m_header = reinterpret_cast<shm_ring_header*>(memory);
+                m_data = memory + SHM_RING_HEADER_SIZE;
+                m_header->capacity = capacity;
+                m_header->stop.store(0, std::memory_order_relaxed);
+                m_header->tail.store(0, std::memory_order_relaxed);
+                m_header->head.store(0, std::memory_order_release);
+
+                return true;
+            }
+
+            // Uses a ring that was initialized by the other side. Fails if the stored capacity does not fit into the memory.
+            bool attach(char* memory, size_t size){
+                if(memory == nullptr || size < SHM_RING_HEADER_SIZE) return false;
+
+                shm_ring_header* header = reinterpret_cast<shm_ring_header*>(memory);
+                uint64_t capacity = header->capacity;
+                if(capacity < 64 || (capacity & (capacity - 1)) != 0 || capacity > size - SHM_RING_HEADER_SIZE) return false;
+
+                m_header = header;
+                m_data = memory + SHM_RING_HEADER_SIZE;
+                return true;
+            }
+
+            // Appends a record (producer side). Returns false if the ring has not enough free space.
+            bool push(const char* data, uint32_t length){
+                uint64_t capacity = m_header->capacity;
+                uint64_t head = m_header->head.load(std::memory_order_relaxed);
+                uint64_t tail = m_header->tail.load(std::memory_order_acquire);
+
+                uint64_t record_size = record_size_of(length);
+                uint64_t offset = head & (capacity - 1);
+                uint64_t padding = offset + record_size > capacity ? capacity - offset : 0;
+
+                if(record_size > capacity || head + padding + record_size - tail > capacity) return false;
+
+                if(padding != 0){
+                    write_length(offset, SHM_RING_PADDING);
+                    head += padding;
+                    offset = 0;
+                }
+
+                write_length(offset, length);
+                memcpy(m_data + offset + 4, data, length);
+                m_header->head.store(head + record_size, std::memory_order_release);
+
+                return true;
+            }
+
+            // Gets the oldest record without removing it (consumer side). The data stays valid until pop is called.
+            shm_ring_front_result front(char* &data, uint32_t &length){
+                uint64_t capacity = m_header->capacity;
+                uint64_t tail = m_header->tail.load(std::memory_order_relaxed);
+                uint64_t head = m_header->head.load(std::memory_order_acquire);
+
+                if(tail == head) return SHM_RING_EMPTY;
+
+                uint64_t offset = tail & (capacity - 1);
+                uint32_t record_length = read_length(offset);
+
+                // Skip the padding at the end of the ring.
+                if(record_length == SHM_RING_PADDING){
+                    tail += capacity - offset;
+                    m_header->tail.store(tail, std::memory_order_release);
+                    if(tail == head) return SHM_RING_EMPTY;
+
+                    offset = 0;
+                    record_length = read_length(offset);
+                }
+
+                // The producer publishes the head after the whole record, so a record behind the head is malformed and not incomplete.
+                uint64_t record_size = record_size_of(record_length);
+                if(record_size > capacity - offset || record_size > head - tail) return SHM_RING_MALFORMED;
+
+                data = m_data + offset + 4;
+                length = record_length;
+                return SHM_RING_RECORD;
+            }
+
+            // Removes the record returned by front (consumer side).
+            void pop(){
+                uint64_t tail = m_header->tail.load(std::memory_order_relaxed);
+                uint32_t length = read_length(tail & (m_header->capacity - 1));
+                m_header->tail.store(tail + record_size_of(length), std::memory_order_release);
+            }
+
+            // Checks if a record of the given length fits into the ring without waiting for the consumer.
+            bool has_space(uint32_t length){
+                uint64_t capacity = m_header->capacity;
+                uint64_t head = m_header->head.load(std::memory_order_relaxed);
+                uint64_t offset = head & (capacity - 1);
+                uint64_t record_size = record_size_of(length);
+                uint64_t padding = offset + record_size > capacity ? capacity - offset : 0;
+
+                return head + padding + record_size - m_header->tail.load(std::memory_order_acquire) <= capacity;
+            }
+
+            // Sets the stop flag, which tells the other side to stop using the ring.
+            void request_stop(){
+                m_header->stop.store(1, std::memory_order_release);
+            }
+
+            // Checks if the stop flag is set.
+            bool is_stop_requested() const {
+                return m_header->stop.load(std::memory_order_acquire) != 0;
+            }
+
+        private:
+
+            // Size of a record in the ring, including the length and the alignment.
+            static uint64_t record_size_of(uint32_t length){
+                return ((uint64_t)length + 4 + 7) & ~(uint64_t)7;
+            }
+
+            void write_length(uint64_t offset, uint32_t length){
+                memcpy(m_data + offset, &length, sizeof(length));
+            }
+
+            uint32_t read_length(uint64_t offset) const {
+                uint32_t length;
+                memcpy(&length, m_data + offset, sizeof(length));
+                return length;
+            }
+
+            // Header and data of the ring.
+            shm_ring_header* m_header = nullptr;
+            char* m_data = nullptr;
+    };
+
+    // Waits a bit longer with every round while polling a ring: first spinning, then yielding, then sleeping, so an idle poller does not burn a core.
+    inline void shm_ring_backoff(uint32_t &round){
+        if(round < 64){
+            // Spin.
+        }else if(round < 128){
+            sched_yield();
+        }else{
+            struct timespec duration = {0, 50000};
+            nanosleep(&duration, nullptr);
+        }
+        round++;
+    }
+}
+
+#endif
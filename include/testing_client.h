@@ -51,8 +51,50 @@ namespace testing{
             // Virtual function to send a request and wait for the response (and fill the response). Needs to be overwritten.
             virtual bool send_request(request* req, response* res) = 0;
 
+            // Closes the ends of the communication that only the receiver (VP) uses. Must be called in the parent after the VP was forked, so a crashed VP is noticed as end of file instead of a blocking read.
+            virtual void close_receiver_end(){}
+
+            // Sets how long send_request waits for a response in milliseconds (0 waits forever). A VP that does not respond in time is considered hung.
+            void set_response_timeout(uint32_t timeout_ms){
+                m_response_timeout_ms = timeout_ms;
+            }
+
+            // Indicates that the last send_request failed because the response timeout expired.
+            bool has_timed_out() const {
+                return m_timed_out;
+            }
+
+            // Sends HELLO with the protocol version and the requested capabilities of the client and stores the outcome (see get_protocol). A VP without HELLO answers with empty data, then version 0 without capabilities is stored, so the client falls back to the basic commands. check_for_ready calls this once the VP is ready, unless disabled with set_negotiation.
+            bool negotiate();
+
+            // Enables or disables the negotiation in check_for_ready and sets the capabilities the client requests (default all except CAPABILITY_NATIVE_BYTE_ORDER).
+            void set_negotiation(bool enabled, uint32_t capabilities = CAPABILITIES_DEFAULT){
+                m_negotiate = enabled;
+                m_requested_capabilities = capabilities;
+            }
+
+            // Getter for the outcome of the negotiation: protocol version of the VP, capabilities of both, maximum message size of both and coverage map size (0 if unknown).
+            const protocol_info& get_protocol() const {
+                return m_protocol;
+            }
+
+            // Checks if the VP and the client support all given capabilities, so the client can choose the fastest command both support.
+            bool supports(uint32_t capabilities) const {
+                return (m_protocol.capabilities & capabilities) == capabilities;
+            }
+
+            // Byte order of the integers in requests and responses after the negotiation, to be used with the functions of byte_order.h.
+            byte_order get_byte_order() const {
+                return supports(CAPABILITY_NATIVE_BYTE_ORDER) ? BYTE_ORDER_NATIVE : BYTE_ORDER_BIG_ENDIAN;
+            }
+
+            // Maximum data length of a request or response that the client can transfer. By default not limited.
+            virtual uint32_t get_max_message_size(){
+                return UINT32_MAX;
+            }
+
             // Function that does not do any logging.
-            static void no_logging(const char* fmt, ...){};
+            static void no_logging(const char*, ...){};
 
             // Pointer to a function for info logging. It points to the no_logging function by default.
             void (*log_info_message)(const char* fmt, ...) = no_logging;
@@ -64,6 +106,19 @@ namespace testing{
 
             // Indicates if the communication was started.
             bool m_started = false;
+
+            // Response timeout in milliseconds, 0 waits forever.
+            uint32_t m_response_timeout_ms = 0;
+
+            // Indicates that the last response timed out.
+            bool m_timed_out = false;
+
+            // Negotiation with HELLO in check_for_ready and the requested capabilities.
+            bool m_negotiate = true;
+            uint32_t m_requested_capabilities = CAPABILITIES_DEFAULT;
+
+            // Outcome of the negotiation.
+            protocol_info m_protocol;
     };
 
     // testing_client implementation for message queue communication.
@@ -76,12 +131,15 @@ namespace testing{
             // Implemented start function, which openes the message queues. Both message queues will be cleared during starting.
             bool start() override;
 
-            // Implemented check_for_ready function, which check for the "ready" message once, without blocking.
+            // Implemented check_for_ready function, which check for the "ready" message once, without blocking. Once it was received, the protocol is negotiated (see negotiate).
             bool check_for_ready() override;
 
             // Implemented wait_for_ready function, which waits (blocks) until the "ready" string is received on the response message queue.
             bool wait_for_ready() override;
 
+            // The data of a request or response must fit into one message (MQ_MAX_LENGTH).
+            uint32_t get_max_message_size() override;
+
             // Implemented send_request function, which uses the message queues. For the received data, new memory will be allocated, so after res was used it needs to be freed propertly. If res.data is not a nullptr, the function will try to free it.
             bool send_request(request* req, response* res) override;
 
@@ -125,7 +183,7 @@ namespace testing{
             // Implemented start function, which openes the pipes. Both pipes will be cleared during starting.
             bool start() override;
 
-            // Implemented check_for_ready function, which check for the "ready" message once, without blocking.
+            // Implemented check_for_ready function, which check for the "ready" message once, without blocking. Once it was received, the protocol is negotiated (see negotiate).
             bool check_for_ready() override;
 
             // Implemented wait_for_ready function, which waits (blocks) until the "ready" string is received on the response pipe.
@@ -134,6 +192,9 @@ namespace testing{
             // Implemented send_request function, which uses the pipes. For the received data, new memory will be allocated, so after res was used it needs to be freed propertly. If res.data is not a nullptr, the function will try to free it.
             bool send_request(request* req, response* res) override;
 
+            // Closes the read end of the request pipe and the write end of the response pipe (and the specific fds) in this process. The remaining ends are closed on exec.
+            void close_receiver_end() override;
+
             // Getter for the used read FD of the request queue.
             int get_request_fd();
 
@@ -149,14 +210,14 @@ namespace testing{
             bool m_specific_fds = false;
 
             // File descriptor of the request pipe.
-            int m_request_fd;
+            int m_request_fd = -1;
 
             // File descriptor of the response pipe.
-            int m_response_fd;
+            int m_response_fd = -1;
 
-            int m_request_pipe[2];
+            int m_request_pipe[2] = {-1, -1};
             
-            int m_response_pipe[2];
+            int m_response_pipe[2] = {-1, -1};
     };
 }
 
@@ -0,0 +1,224 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TESTING_CLIENT_POOL_H
+#define TESTING_CLIENT_POOL_H
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "testing_client.h"
+#include "types.h"
+
+namespace testing{
+
+    // Configuration of a testing_client_pool. The callbacks are called from the worker threads, creating and spawning is serialized by the pool.
+    struct testing_client_pool_config{
+        // Number of VP instances (and worker threads).
+        size_t worker_count = 1;
+
+        // Creates the (not started) client of a worker, for example a pipe_testing_client with the fds the VP expects or a mq_testing_client with queue names unique to the worker.
+        std::function<testing_client*(size_t worker)> create_client;
+
+        // Starts the VP process of a worker after the client was started (for example fork and exec) and returns its pid or -1. A mq_testing_client needs set_receiver to be called here.
+        std::function<pid_t(size_t worker, testing_client* client)> spawn_vp;
+
+        // Optional, called once the VP is ready to send the setup requests (breakpoints, MMIO tracking, ...). Returning false discards the VP.
+        std::function<bool(size_t worker, testing_client* client)> setup;
+
+        // Optional name of a POSIX shared memory object for the global coverage. The pool creates it and attaches every VP to it (ATTACH_GLOBAL_COVERAGE) before the setup, so the VPs merge their coverage into one map and report if a run found something new for the whole pool.
+        std::string global_coverage;
+
+        // Time a VP has to send the ready message in milliseconds.
+        uint32_t ready_timeout_ms = 10000;
+
+        // Time a test case may take before the VP is considered hung in milliseconds (0 waits forever).
+        uint32_t run_timeout_ms = 1000;
+    };
+
+    // Test case dispatched by a testing_client_pool, sent as one request.
+    struct pool_test_case{
+        uint64_t id = 0;
+        command request_command = DO_RUN;
+        std::vector<char> data;
+    };
+
+    // Outcome of a test case.
+    // POOL_RUN_OK: The response was received, POOL_RUN_ERROR: The VP responded with an error or the communication failed, POOL_RUN_CRASHED: The VP exited during the test case, POOL_RUN_HUNG: The VP did not respond in time and was killed.
+    enum pool_run_outcome{
+        POOL_RUN_OK, POOL_RUN_ERROR, POOL_RUN_CRASHED, POOL_RUN_HUNG
+    };
+
+    // Result of a test case, passed to the result callback.
+    struct pool_test_result{
+        uint64_t id = 0;
+        size_t worker = 0;
+        pool_run_outcome outcome = POOL_RUN_OK;
+        status response_status = STATUS_OK;
+
+        // Wait status of the VP (see waitpid), only valid for POOL_RUN_CRASHED.
+        int exit_status = 0;
+
+        // Response data.
+        std::vector<char> data;
+    };
+
+    // Aggregated counters of a testing_client_pool.
+    struct pool_statistics{
+        uint64_t executed = 0;
+        uint64_t errors = 0;
+        uint64_t crashes = 0;
+        uint64_t hangs = 0;
+        uint64_t restarts = 0;
+    };
+
+    // Runs test cases on a pool of VP instances over any testing_client. Every worker thread owns one VP, which is kept running between test cases and restarted after a crash or hang. Test cases are distributed over per-worker deques, an idle worker steals half of the deque of another worker, so the workers only share the result callback.
+    class testing_client_pool{
+        public:
+
+            testing_client_pool(const testing_client_pool_config &config);
+
+            // Stops the pool.
+            ~testing_client_pool();
+
+            testing_client_pool(const testing_client_pool&) = delete;
+            testing_client_pool& operator=(const testing_client_pool&) = delete;
+
+            // Starts the worker threads and waits until all VPs are ready. SIGPIPE is ignored, so writing to a crashed VP fails instead of terminating the process.
+            bool start();
+
+            // Stops the worker threads after their current test case, kills the VPs and drops the test cases that were not executed.
+            void stop();
+
+            // Adds test cases, they are distributed round-robin over the workers.
+            void submit(pool_test_case test_case);
+            void submit(std::vector<pool_test_case> &test_cases);
+
+            // Waits until all submitted test cases have a result. Returns false if no worker is running anymore.
+            bool wait_idle();
+
+            // Sets the callback for results. It is called from the worker threads, but never concurrently.
+            void set_result_callback(std::function<void(const pool_test_result&)> callback);
+
+            // Getter for the aggregated counters.
+            pool_statistics get_statistics() const;
+
+            // Getter for the number of workers.
+            size_t get_worker_count() const;
+
+            // Getter for the global coverage (MAP_SIZE bytes of bucket bits), nullptr if not configured or not started.
+            const uint8_t* get_global_coverage() const;
+
+            // Logging functions, which are also set for the clients.
+            void (*log_info_message)(const char* fmt, ...) = testing_client::no_logging;
+            void (*log_error_message)(const char* fmt, ...) = testing_client::no_logging;
+
+        private:
+
+            // State of one worker.
+            struct worker{
+                size_t index;
+                std::unique_ptr<testing_client> client;
+                pid_t pid = -1;
+                std::thread thread;
+
+                // Test cases of this worker, also stolen from by the other workers.
+                std::mutex queue_mutex;
+                std::deque<pool_test_case> queue;
+            };
+
+            // Main loop of a worker thread.
+            void worker_loop(worker &current);
+
+            // Takes the next test case from the own deque or steals from another worker.
+            bool next_test_case(worker &current, pool_test_case &test_case);
+
+            // Sends a test case and restarts the VP if it crashed or hung.
+            void execute(worker &current, pool_test_case &test_case);
+
+            // Creates the client, spawns the VP and waits for the ready message.
+            bool spawn_worker(worker &current);
+
+            // Kills and reaps the VP and deletes the client.
+            void kill_worker(worker &current);
+
+            // Passes a result to the callback and updates the counters.
+            void deliver(pool_test_result &result);
+
+            // Creates and maps the global coverage.
+            bool create_global_coverage();
+
+            // Unmaps and removes the global coverage.
+            void remove_global_coverage();
+
+            testing_client_pool_config m_config;
+
+            std::vector<std::unique_ptr<worker>> m_workers;
+
+            // Mapping of the global coverage.
+            uint8_t* m_global_coverage = nullptr;
+
+            // Serializes create_client, start and spawn_vp (pipe clients may dup2 onto fixed fds).
+            std::mutex m_spawn_mutex;
+
+            // Wakes up idle workers.
+            std::mutex m_work_mutex;
+            std::condition_variable m_work_condition;
+
+            // Wakes up wait_idle and start.
+            std::mutex m_idle_mutex;
+            std::condition_variable m_idle_condition;
+
+            // Serializes the result callback.
+            std::mutex m_result_mutex;
+            std::function<void(const pool_test_result&)> m_result_callback;
+
+            // Test cases in the deques and submitted test cases without result.
+            std::atomic<size_t> m_queued{0};
+            std::atomic<size_t> m_pending{0};
+
+            // Next worker for submit.
+            std::atomic<size_t> m_next_worker{0};
+
+            // Workers that started their VP (or failed to) and workers that are running.
+            size_t m_started_workers = 0;
+            size_t m_running_workers = 0;
+
+            std::atomic<bool> m_stop{false};
+
+            std::atomic<uint64_t> m_executed{0};
+            std::atomic<uint64_t> m_errors{0};
+            std::atomic<uint64_t> m_crashes{0};
+            std::atomic<uint64_t> m_hangs{0};
+            std::atomic<uint64_t> m_restarts{0};
+    };
+}
+
+#endif
@@ -20,6 +20,7 @@
 #ifndef FUZZING_TEST_INTERFACE_H
 #define FUZZING_TEST_INTERFACE_H
 
+#include <atomic>
 #include <limits>
 #include <mqueue.h>
 #include <string>
@@ -28,6 +29,8 @@
 #include <unistd.h>
 #include <sys/ioctl.h>
 
+#include "byte_order.h"
+#include "request_trace.h"
 #include "types.h"
 
 namespace testing{
@@ -39,8 +42,8 @@ namespace testing{
     class testing_communication{
         public: 
 
-            // Creates a testing interface, this requires a pointer to the test_receiver.
-            testing_communication(testing_receiver* receiver):m_testing_receiver(receiver){};
+            // Creates a testing interface, this requires a pointer to the test_receiver. If the environment variable VPTI_RECORD contains a path, the recording into this file is started.
+            testing_communication(testing_receiver* receiver);
 
             // Destructor, not required but may be overwriten by an implementation.
             virtual ~testing_communication() {}
@@ -60,24 +63,62 @@ namespace testing{
             // Function to read the received request. Needs to be overwritten.
             request get_request();
 
+            // Maximum data length of a request or response that the interface can transfer (reported with HELLO). By default not limited.
+            virtual uint32_t get_max_message_size();
+
             // Setting a response to STATUS_MALFORMED.
             static void respond_malformed(response &res);
 
+            // Sets the byte order of the request and response data of this communication. The receiver switches to BYTE_ORDER_NATIVE when it was negotiated with HELLO, otherwise big endian is used. The static conversions below are not affected.
+            void set_byte_order(byte_order order);
+
+            // Returns the byte order of the request and response data of this communication.
+            inline byte_order get_byte_order() const {
+                return m_byte_order.load(std::memory_order_relaxed);
+            }
+
             // Copying a 32bit integer to a buffer at a start index MSB.
-            static void int32_to_bytes(int32_t value, char* buffer, size_t start);
+            static inline void int32_to_bytes(int32_t value, char* buffer, size_t start){
+                store_uint32((uint32_t)value, buffer + start, BYTE_ORDER_BIG_ENDIAN);
+            }
 
             // Copying a 32bit integer from a buffer at a start index MSB.
-            static int32_t bytes_to_int32(const char* buffer, size_t start);
+            static inline int32_t bytes_to_int32(const char* buffer, size_t start){
+                return (int32_t)load_uint32(buffer + start, BYTE_ORDER_BIG_ENDIAN);
+            }
 
             // Copying a 64bit integer to a buffer at a start index MSB.
-            static void int64_to_bytes(int64_t value, char* buffer, size_t start);
-            
+            static inline void int64_to_bytes(int64_t value, char* buffer, size_t start){
+                store_uint64((uint64_t)value, buffer + start, BYTE_ORDER_BIG_ENDIAN);
+            }
+
             // Copying a 64bit integer from a buffer at a start index MSB.
-            static int64_t bytes_to_int64(const char* buffer, size_t start);
+            static inline int64_t bytes_to_int64(const char* buffer, size_t start){
+                return (int64_t)load_uint64(buffer + start, BYTE_ORDER_BIG_ENDIAN);
+            }
 
             // Checks if a uint64_t can be safely casted to uint32_t.
             static bool check_cast_to_uint32(uint64_t value);
 
+            // Starts recording every request and response with timestamps into a trace file (see request_trace_writer), which can be replayed with vpti-replay. Response data is only recorded with response_data, otherwise only the status and the length of responses.
+            bool start_recording(const std::string &path, bool response_data = false);
+
+            // Writes the remaining records and stops the recording.
+            void stop_recording();
+
+            // Records a received request, if recording. The records are written before a KILL request is handled, because it may end the process.
+            inline void record_request(const request &req){
+                if(!m_recorder.is_open()) return;
+
+                m_recorder.write_request(req);
+                if(req.request_command == KILL) m_recorder.flush();
+            }
+
+            // Records the response to the last request, if recording.
+            inline void record_response(const response &res){
+                if(m_recorder.is_open()) m_recorder.write_response(res);
+            }
+
         protected:
 
             // Pointer to the test_receiver that was specified during construction. With this functions like logging can be accessed of the test_receiver.
@@ -89,6 +130,12 @@ namespace testing{
             // Indicates if the communication was started.
             bool m_started = false;
 
+            // Recorder of the requests and responses.
+            request_trace_writer m_recorder;
+
+            // Byte order of the request and response data, written by the receiver loop and read by the simulation thread for event data.
+            std::atomic<byte_order> m_byte_order{BYTE_ORDER_BIG_ENDIAN};
+
     };
 
     // testing_communication implementation for message queues (MQ) communication.
@@ -110,6 +157,9 @@ namespace testing{
             // Implemented function that checks for new requests. This function checks the request message queue for new messages and saves the first into the temporary m_current_req object.
             bool receive_request() override;
 
+            // The data of a request or response must fit into one message (MQ_MAX_LENGTH).
+            uint32_t get_max_message_size() override;
+
         private:
 
             // Clears a message queue by its name.
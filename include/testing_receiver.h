@@ -23,17 +23,27 @@
 #include <semaphore.h>
 #include <sys/shm.h>
 #include <deque>
+#include <functional>
+#include <memory>
 #include <thread>
 #include <cstring>
 #include <vector>
 #include <unistd.h>
 
 #include "testing_communication.h"
+#include "coverage_map.h"
+#include "coverage_policy.h"
+#include "event_push.h"
+#include "fixed_read_table.h"
+#include "memory_snapshot.h"
+#include "mmio_range_index.h"
+#include "mmio_read_queue.h"
+#include "mmio_trace.h"
+#include "shared_memory.h"
+#include "shm_ring.h"
+#include "thread_placement.h"
 #include "types.h"
 
-#define MAP_SIZE_POW2 16
-#define MAP_SIZE (1 << MAP_SIZE_POW2)
-
 namespace testing{
 
     // Abstract definition of the test receiver. This class manages the different commands that are received via the testing communication. This class need to be implemented for the specific virtual platform.
@@ -56,18 +66,66 @@ namespace testing{
             // Sets the communication object that should be for communication.
             bool set_communication(testing_communication* communcation);
 
-            // Starts the receiver loop inside a new thread, thus starts the receiving of requests.
+            // Starts the receiver loop inside a new thread, thus starts the receiving of requests. The placement set with set_receiver_thread_placement is applied to the thread.
             bool start_receiver_in_thread();
 
+            // Sets the CPU set and scheduling policy of the receiver thread. Must be called before start_receiver_in_thread. If the receiver loop runs in a thread of the VP, the VP calls apply_thread_placement in it instead.
+            void set_receiver_thread_placement(const thread_placement &placement);
+
+            // Sets the CPU set and scheduling policy of the simulation thread, which is applied when the VP calls place_simulation_thread from it.
+            void set_simulation_thread_placement(const thread_placement &placement);
+
+            // Places the coverage shards, the seen coverage and the DO_RUN_POSIX_SHM input region on a NUMA node, optionally with transparent huge pages. With numa_node -1 the node of the first CPU of the simulation thread placement is used (if set). Existing buffers are moved, later buffers are placed when they are allocated.
+            bool set_memory_placement(int numa_node, bool huge_pages);
+
             // Infinite loop which checks the communication interface for new requests and then calls the corresponding handlers. After a request is handeled it will send a response back.
             void receiver_loop();
 
             // Handler for the DO_RUN_SHM command, which reads the test case from the given shared memory region and then calls the handle_do_run function. If stop_after_string_termination is enabled it will stop read the shared memory after the first "\0" (termination character).
             status handle_do_run_shm(std::string start_breakpoint, std::string end_breakpoint, uint64_t mmio_address, size_t mmio_length, int shm_id, unsigned int offset, bool stop_after_string_termination, std::string &register_name);
 
-            // Handler for the GET_CODE_COVERAGE_SHM command, which writes the coverage map (m_bb_array) to the given shared memory region with a given offset.
+            // Handler for the DO_RUN_POSIX_SHM command, which reads the test case from a POSIX shared memory or memfd region with a shm_input_header and then calls the handle_do_run function. The exact length is taken from the header, so binary data is supported and the data is not scanned. The region stays mapped for the next runs.
+            status handle_do_run_posix_shm(std::string &start_breakpoint, std::string &end_breakpoint, uint64_t mmio_address, size_t mmio_length, std::string &region_name, std::string &register_name);
+
+            // Handler for the GET_CODE_COVERAGE_SHM command, which writes the (merged) coverage map to the given shared memory region with a given offset.
             status handle_get_code_coverage_shm(int shm_id, unsigned int offset);
 
+            // Handler for the DO_RUN_BATCH command, which runs case_count test cases back to back via handle_do_run. The test cases are read from the input shared memory, described by a table of (offset, length) entries at table_offset. For every test case a result record (return code, status, terminating event, new coverage flag and coverage hash) is written to the result shared memory at result_offset. If coverage_slots is set, the coverage map of every test case is written after the records. The number of executed test cases is written to executed_cases.
+            status handle_do_run_batch(std::string &start_breakpoint, std::string &end_breakpoint, uint64_t mmio_address, size_t mmio_length, int input_shm_id, uint32_t case_count, uint32_t table_offset, int result_shm_id, uint32_t result_offset, bool coverage_slots, std::string &register_name, uint32_t &executed_cases);
+
+            // Handler for the PERSISTENT_RUN command, which runs test cases via handle_do_run in a loop without a request per test case. The test cases are taken from the input ring (an shm_ring initialized by the client) and for every test case a DO_RUN_BATCH result record is pushed into the result ring. The loop ends when the client sets the stop flag of the input ring or after max_runs test cases (0 for no limit), a malformed record in the input ring ends it with STATUS_ERROR. If restore_snapshot is set, the last snapshot is restored before each test case. The number of executed test cases is written to executed_cases.
+            status handle_persistent_run(std::string &start_breakpoint, std::string &end_breakpoint, uint64_t mmio_address, size_t mmio_length, int input_shm_id, uint32_t input_offset, int result_shm_id, uint32_t result_offset, uint32_t max_runs, bool restore_snapshot, std::string &register_name, uint32_t &executed_cases);
+
+            // Handler for the FORK_SERVER command, which runs to the start breakpoint once (via handle_fork_server_start) and then switches to the fork server mode: every following DO_RUN, DO_RUN_SHM, DO_RUN_POSIX_SHM and RUN_PREPARED command (and every test case of DO_RUN_BATCH) is executed in a forked child with copy-on-write memory, while this process waits and relays the result. The children are already at the start breakpoint, so the run handlers get an empty start breakpoint and run from the current state. A child that does not finish within timeout_ms (0 for no timeout) is killed. The simulation must run in the thread of the receiver loop, because only this thread exists in the child, so the command fails (STATUS_ERROR) if the receiver was started with start_receiver_in_thread.
+            status handle_fork_server(std::string &start_breakpoint, uint32_t timeout_ms);
+
+            // Handler for the ATTACH_GLOBAL_COVERAGE command, which maps the global coverage (a POSIX shared memory object of at least MAP_SIZE bytes, shared by many VPs). After each run the bucketed coverage is merged into it with atomic operations and the run result reports if the run set buckets no run of any VP set before. An empty name detaches the global coverage.
+            status handle_attach_global_coverage(std::string &name);
+
+            // Handler for the ENABLE_EVENT_PUSH command, which attaches the event ring at offset in the given shared memory (an shm_ring initialized by the client). Afterwards every notified event whose bit (1 << event_type) is set in event_mask, and every run end reported with report_run_end, is pushed to the ring as a pushed_event with a sequence number and the simulated time. If wakeup_offset is not EVENT_PUSH_NO_WAKEUP, the 4 byte word at this offset is incremented after every event and waiters are woken up (see event_push_channel::wait).
+            status handle_enable_event_push(int shm_id, uint32_t offset, uint32_t wakeup_offset, uint32_t event_mask);
+
+            // Handler for the DISABLE_EVENT_PUSH command, which stops pushing events and detaches the shared memory.
+            status handle_disable_event_push();
+
+            // Handler for the SET_RUN_BUDGET command, which sets the limits of every following run. The VP checks them with check_run_budget during the run.
+            status handle_set_run_budget(const run_budget &budget);
+
+            // Handler for the HELLO command, which stores the protocol version and capabilities of the client and returns the version of the VP, the capabilities that both support (see handle_get_capabilities), the maximum message size of the communication and the coverage map size.
+            status handle_hello(uint32_t client_version, uint32_t client_capabilities, protocol_info &info);
+
+            // Handler for the SET_RUN_OPTIONS command. With RUN_OPTION_RESULT_RECORD the DO_RUN, DO_RUN_SHM, DO_RUN_POSIX_SHM and RUN_PREPARED commands reset the coverage before the run and append a result record to their response.
+            status handle_set_run_options(uint8_t options);
+
+            // Handler for the ENABLE_MMIO_TRACE command, which attaches the trace ring at offset in the given shared memory (initialized by the client). Afterwards the VP writes tracked MMIO accesses with trace_mmio_access instead of triggering events.
+            status handle_enable_mmio_trace(int shm_id, uint32_t offset, mmio_trace_encoding encoding, mmio_trace_policy policy);
+
+            // Handler for the DISABLE_MMIO_TRACE command, which flushes the trace and detaches the ring.
+            status handle_disable_mmio_trace();
+
+            // Handler for the SET_CODE_COVERAGE_SAMPLING command, which sets the sampling mode of the coverage trackers of all shards. The period is the average number of blocks for SAMPLE_BLOCKS and the interval in microseconds for SAMPLE_TIME.
+            status handle_set_code_coverage_sampling(coverage_sampling sampling, uint32_t period, uint32_t seed);
+
             // Triggering VP_ERROR event from any context.
             static void notify_VP_ERROR_event();
             
@@ -88,12 +146,32 @@ namespace testing{
             // Helper for notifiying and adding MMIO_WRITE event. Allocats the memory for the additional data.
             void notify_MMIO_WRITE_event(uint64_t address, uint32_t length, char* data);
 
+            // Same as notify_MMIO_READ_event, but the ID of the tracked range (see get_mmio_tracking_ranges) is appended to the event data.
+            void notify_MMIO_READ_event(uint64_t address, uint32_t length, uint32_t range_id);
+
+            // Same as notify_MMIO_WRITE_event, but the ID of the tracked range (see get_mmio_tracking_ranges) is appended to the event data.
+            void notify_MMIO_WRITE_event(uint64_t address, uint32_t length, char* data, uint32_t range_id);
+
             // Helper for notifiying and adding VP_END event.
             void notify_VP_END_event();
 
             // Helper for notifiying and adding BREAKPOINT_HIT event. Allocats the memory for the additional data.
             void notify_BREAKPOINT_HIT_event(std::string &symbol_name);
 
+            // Applies the placement set with set_simulation_thread_placement to the calling thread. The VP calls this from its simulation thread before the simulation starts (for example before sc_start).
+            bool place_simulation_thread();
+
+            // Checks if the input of the current DO_RUN_POSIX_SHM run has the same sequence number as the input of the previous run, so the VP can reuse data derived from it.
+            bool is_input_reused() const;
+
+            // Checks if the MMIO trace is enabled. Then the VP should call trace_mmio_access for tracked accesses instead of notifying MMIO_READ / MMIO_WRITE events, so the simulation does not stop.
+            inline bool is_mmio_trace_enabled() const {
+                return m_mmio_trace.is_attached();
+            }
+
+            // Appends a tracked MMIO access (width 1 to 8 bytes, value in memory order) with the simulated time in picoseconds to the trace.
+            void trace_mmio_access(uint64_t address, uint32_t width, const char* value, bool write, uint32_t range_id, uint64_t timestamp);
+
             // Function that blocks until a new event occoured, via the m_full_slots mutex.
             void wait_for_event();
 
@@ -103,17 +181,142 @@ namespace testing{
             // Getter for the first event of the event queue. This will also remove this first event. Freeing of the additional data is not managed inside testing_receiver and must called after the dat is used!
             event get_and_remove_first_event();
 
-            // Function to reset the code coverage, by writing zeros to m_bb_array.
+            // Function to reset the code coverage, by writing zeros to the coverage maps of all shards. Only the entries touched since the last reset are cleared.
             void reset_code_coverage();
 
-            // Getter for the code coverage array as a string.
+            // Getter for the code coverage array as a string. The maps of all shards are merged.
             std::string get_code_coverage();
 
-            // Setter for a specific entry (determined by the process counter) in the code coverage array.
+            // Setter for a specific entry (determined by the process counter) in the code coverage array. This hashes the pc on every call, if possible the VP should use register_block and hit_block instead.
             void set_block(uint64_t pc);
 
+            // Same as set_block, but for a specific coverage shard (for example the index of the core that executed the block).
+            void set_block(uint64_t pc, size_t shard);
+
+            // Computes the stable, pre-hashed coverage ID of a basic block by its address. The VP should call this once when a block is translated and store the ID with the block.
+            static constexpr uint32_t register_block(uint64_t pc){
+                return (uint32_t)(((pc >> 4) ^ (pc << 8)) & (MAP_SIZE - 1));
+            }
+
+            // Records the execution of a block by its ID from register_block. This is the inlined hot path of set_block for the VP's per-block hook: it counts the block, computes the map entry with the COVERAGE_POLICY (by default the AFL style edge, one XOR and one shift) and, unless the sampling (SET_CODE_COVERAGE_SAMPLING) skips the block, increments the map entry (saturating) and logs it on its first hit, so the reset only clears touched entries. The tracker of the first shard is cached, and without sampling the countdown is not touched.
+            inline void hit_block(uint32_t block_id){
+                m_primary_tracker->hit_block(block_id);
+            }
+
+            // Same as hit_block, but for a specific coverage shard. The shard index must be smaller than get_coverage_shard_count().
+            inline void hit_block(uint32_t block_id, size_t shard){
+                m_coverage_shards[shard]->tracker.hit_block(block_id);
+            }
+
+            // Notifies the coverage policy about a function call from the given call site (for example register_block of the calling block). Only call_context_edge_coverage uses it, the other policies ignore it.
+            inline void on_call(uint32_t call_site_id){
+                m_primary_tracker->on_call(call_site_id);
+            }
+
+            inline void on_call(uint32_t call_site_id, size_t shard){
+                m_coverage_shards[shard]->tracker.on_call(call_site_id);
+            }
+
+            // Notifies the coverage policy about a function return.
+            inline void on_return(){
+                m_primary_tracker->on_return();
+            }
+
+            inline void on_return(size_t shard){
+                m_coverage_shards[shard]->tracker.on_return();
+            }
+
+            // Sets the number of coverage shards. Every shard has its own coverage map and previous block state, so each core (or simulation thread) of a multi-core VP can write to its own shard without sharing cache lines or corrupting the edge context of the other cores. The shards are merged when the coverage is read. This resets the coverage and must be called before the simulation is started. The default is one shard.
+            bool set_coverage_shard_count(size_t count);
+
+            // Getter for the number of coverage shards.
+            size_t get_coverage_shard_count();
+
+            // Reports the event that terminated the current run (for example ERROR_SYMBOL_HIT), if it was not the end breakpoint. Should be called by the VP inside handle_do_run.
+            void report_run_end(event_type end_event);
+
+            // Checks the budget of the current run (see SET_RUN_BUDGET) with the executed instructions and the simulated time in picoseconds of the run (0 if the VP does not count them). The VP calls this during the run, for example for every block or at the end of every quantum. The instructions, the simulated time and the blocks of the first shard are compared on every call, the wall time, the blocks of all shards and the loop detection every RUN_BUDGET_CHECK_STRIDE calls. Returns true if the budget is exhausted, the run end is then reported as HANG and the VP must stop the run and return from handle_do_run.
+            inline bool check_run_budget(uint64_t instruction_count = 0, uint64_t simulation_time = 0){
+                if(!m_run_budget_enabled) return false;
+
+                if(instruction_count >= m_instruction_limit || simulation_time >= m_simulation_time_limit || m_primary_tracker->get_block_count() >= m_block_limit){
+                    return exhaust_run_budget();
+                }
+
+                if(--m_run_budget_countdown == 0) return check_run_budget_periodic();
+
+                return m_run_budget_exhausted;
+            }
+
+            // Reports the number of executed instructions and the simulated time in picoseconds of the current run. Should be called by the VP at the end of handle_do_run, if it can count them.
+            void report_run_statistics(uint64_t instruction_count, uint64_t simulation_time);
+
+            // Pushes an event with the simulated time (via handle_get_simulation_time) to the push channel.
+            void push_event(event_type type, const char* data, uint32_t data_length);
+
+            // Starts the budget of a run, called before every run.
+            void begin_run_budget();
+
+            // Checks the wall time, the blocks of all shards and the loop detection of the run budget.
+            bool check_run_budget_periodic();
+
+            // Marks the run budget as exhausted and reports the run end as HANG. Returns true.
+            bool exhaust_run_budget();
+
+            // Returns the number of executed blocks of all shards.
+            uint64_t total_block_count();
+
+            // Calculates the hash of the bucketed coverage of all shards.
+            uint64_t hash_code_coverage();
+
+            // Merges the bucketed coverage of all shards into the coverage seen by previous runs. Returns true if the coverage contains buckets that were not seen before.
+            bool update_seen_code_coverage();
+
+            // Merges the bucketed coverage of all shards into the global coverage. Returns true if this run set buckets that were not set before. Must be called after update_seen_code_coverage, which merges the shards.
+            bool update_global_code_coverage();
+
+            // Getter for the coverage map of a shard. The VP should record blocks with hit_block, so the block count, the sampling, the run budget and the reset of the tracker stay consistent. Another coverage policy is selected with COVERAGE_POLICY.
+            coverage_map& get_coverage_map(size_t shard = 0);
+
+            // Getter for the tracked MMIO ranges of the default ADD_MMIO_TRACKING_RANGE and REMOVE_MMIO_TRACKING_RANGE handlers. The VP calls lookup in its bus hook and reports the range ID with the events.
+            mmio_range_index& get_mmio_tracking_ranges();
+
+            // Getter for the fixed reads of the default SET_FIXED_READ and SET_FIXED_READ_WIDE handlers. The VP calls read in its bus hook, most reads without a fixed value are rejected by one bit test.
+            fixed_read_table& get_fixed_reads();
+
+            // Getter for the MMIO read queue filled by the default handle_add_to_mmio_read_queue. The VP calls read on every intercepted bus read and triggers an MMIO_READ event for the bytes that were not available. In handle_do_run the VP can add the run data with push_view, without copying it.
+            mmio_read_queue& get_mmio_read_queue();
+
+            // Getter for the snapshot of the guest memory. The VP registers its guest memory regions (RAM, device memory) with add_region, then the default SNAPSHOT_CREATE and SNAPSHOT_RESTORE handlers use it.
+            memory_snapshot& get_memory_snapshot();
+
+            // Getter for the version and the capabilities of the client, negotiated with HELLO (version 0 if the client did not send HELLO).
+            const protocol_info& get_client_protocol() const;
+
         private:   
 
+            // Byte order of request, response and event data, taken from the communication (big endian unless the native byte order was negotiated with HELLO).
+            byte_order data_byte_order() const {
+                return m_communication != nullptr ? m_communication->get_byte_order() : BYTE_ORDER_BIG_ENDIAN;
+            }
+
+            // Copying integers to or from request, response and event data in data_byte_order.
+            void int32_to_bytes(int32_t value, char* buffer, size_t start) const {
+                store_uint32((uint32_t)value, buffer + start, data_byte_order());
+            }
+
+            int32_t bytes_to_int32(const char* buffer, size_t start) const {
+                return (int32_t)load_uint32(buffer + start, data_byte_order());
+            }
+
+            void int64_to_bytes(int64_t value, char* buffer, size_t start) const {
+                store_uint64((uint64_t)value, buffer + start, data_byte_order());
+            }
+
+            int64_t bytes_to_int64(const char* buffer, size_t start) const {
+                return (int64_t)load_uint64(buffer + start, data_byte_order());
+            }
+
             // Check if the request has exactly the same length as the given length. If not it also changes the response to be STATUS_MALFORMED.
             bool check_exact_request_length(request &req, response &res, size_t length);
 
@@ -141,11 +344,17 @@ namespace testing{
             // Virtual function to handle a DISABLE_MMIO_TRACKING command. Needs to be overwritten. This will disalbe the mmio tracking.
             virtual status handle_disable_mmio_tracking() = 0;
 
+            // Virtual function to handle an ADD_MMIO_TRACKING_RANGE command. This adds a tracked MMIO range with its own ID and mode, in addition to the other ranges. The default adds the range to the library index (get_mmio_tracking_ranges), overlapping ranges and used IDs are rejected.
+            virtual status handle_add_mmio_tracking_range(uint32_t id, uint64_t start_address, uint64_t end_address, char mode);
+
+            // Virtual function to handle a REMOVE_MMIO_TRACKING_RANGE command. This removes a tracked MMIO range by its ID. The default removes it from the library index.
+            virtual status handle_remove_mmio_tracking_range(uint32_t id);
+
             // Virtual function to handle a SET_MMIO_VALUE command. Needs to be overwritten. This function sets the read (and intercepted) MMIO data after a MMIO_READ event. For this mmio tracking must be enabled. If multiple events occoured it will set the value according to the occourance.
             virtual status handle_set_mmio_value(size_t length, char* value) = 0;
 
-            // Virtual function to handle a ADD_TO_MMIO_READ_QUEUE command. Needs to be overwritten. This function adds data according to an address to the MMIO read queue. When a read occures and the address fits data and length inside the read queue, it will use the data and the simulation will not be suspended and MMIO_READ event not be triggered. If data in the read queue is shorter than the request length, the MMIO_READ event will be triggered for the remaining data.
-            virtual status handle_add_to_mmio_read_queue(uint64_t address, size_t length, size_t data_legnth, char* data) = 0;
+            // Virtual function to handle a ADD_TO_MMIO_READ_QUEUE command. This function adds data according to an address to the MMIO read queue. When a read occures and the address fits data and length inside the read queue, it will use the data and the simulation will not be suspended and MMIO_READ event not be triggered. If data in the read queue is shorter than the request length, the MMIO_READ event will be triggered for the remaining data. The default adds the data to the library queue (get_mmio_read_queue), which is a byte stream per address, so length is not used (each read takes the bytes it needs).
+            virtual status handle_add_to_mmio_read_queue(uint64_t address, size_t length, size_t data_length, char* data);
             
             // Virtual function to handle a SET_CPU_INTERRUPT_TRIGGER command. Needs to be overwritten. With this function a interrupt (by its address) can be triggered, if the given address is encountered during simulation.
             virtual status handle_set_cpu_interrupt_trigger(uint64_t interrupt_address, uint64_t trigger_address) = 0;
@@ -168,14 +377,17 @@ namespace testing{
             // Virtual function to handle a GET_RETURN_CODE command. This will return the saved return code. Where and which register should be saved as the return code can be set via SET_RETURN_CODE_ADDRESS. The recording of the return code will be resetted after this call.
             virtual status handle_get_return_code(uint64_t &code) = 0;
 
-            // Virtual function to handle a DO_RUN command. This does one run from a start breakpoint to an endbreakpoint with mmio read queue data. It also records the given register at the end breakpoint and watches an error symbol, if specified.
+            // Virtual function to handle a DO_RUN command. This does one run from a start breakpoint to an endbreakpoint with mmio read queue data. It also records the given register at the end breakpoint and watches an error symbol, if specified. With an empty start breakpoint the run starts from the current state, which is the case for every run in fork server mode (see FORK_SERVER).
             virtual status handle_do_run(std::string &start_breakpoint, std::string &end_breakpoint, uint64_t mmio_address, size_t mmio_length, size_t mmio_data_length, char* mmio_data, std::string &register_name) = 0;
 
             // Virtual function to handle a SET_ERROR_SYMBOL command. This sets a specific symbol that should be watched during the execution. If this symbol is encountered, the simulation is stopped and the event ERROR_SYMBOL_HIT triggered.
             virtual status handle_set_error_symbol(std::string &symbol) = 0;
 
-            // Virtual function to handle a SET_FIXED_READ command. Tthis sets one or multiple fixed read returnes when the MMIO read with the given id event is catched.
-            virtual status handle_set_fixed_read(size_t count, char* data) = 0;
+            // Virtual function to handle a SET_FIXED_READ command. Tthis sets one or multiple fixed read returnes when the MMIO read with the given id event is catched. The default replaces the entries of the library table (get_fixed_reads) with the given 1 byte entries.
+            virtual status handle_set_fixed_read(size_t count, char* data);
+
+            // Virtual function to handle a SET_FIXED_READ_WIDE command. Same as handle_set_fixed_read, but every entry has its own width of 1 to 8 bytes (address, width, value). The entries are already validated. The default replaces the entries of the library table.
+            virtual status handle_set_fixed_read_wide(size_t count, char* data);
 
             // Virtual function to handle a GET_CPU_PC command, for getting the CPU program counter.
             virtual status handle_get_cpu_pc(uint64_t &pc) = 0;
@@ -189,6 +401,30 @@ namespace testing{
             // Virtual function to handle RESTORE_CPU_REGISTER command. THis restores the CPU registers, except the PC.
             virtual status handle_restore_cpu_register() = 0;
 
+            // Virtual function to handle a PREPARE_RUN command. The VP should resolve the symbols and the register of the run once and store them in the resolved fields. The default does not resolve anything, a VP that overrides both handlers adds CAPABILITY_PREPARED_RUN in handle_get_capabilities.
+            virtual status handle_prepare_run(prepared_run &run);
+
+            // Virtual function to handle a RUN_PREPARED command. Does the same as handle_do_run with the parameters of a prepared run. A VP should override this and use the resolved fields. In fork server mode the VP gets a copy of the prepared run with an empty start breakpoint and has to run from the current state (the resolved start address is not used then). The default calls handle_do_run with the stored strings.
+            virtual status handle_run_prepared(prepared_run &run, size_t mmio_data_length, char* mmio_data);
+
+            // Virtual function to run to the start breakpoint of the FORK_SERVER command. The default sets the breakpoint, continues until it is hit and removes it again. With an empty name the current state is used.
+            virtual status handle_fork_server_start(std::string &start_breakpoint);
+
+            // Virtual function, which is called in the forked child of the fork server before the run, for example to restart helper threads of the VP. The default does nothing.
+            virtual void handle_fork_child();
+
+            // Virtual function that returns the current simulated time in picoseconds, which is the timestamp of pushed events (see ENABLE_EVENT_PUSH). It is called from the thread that notifies the event, also from notify_VP_ERROR_event. The default returns 0.
+            virtual status handle_get_simulation_time(uint64_t &time);
+
+            // Virtual function that returns the capabilities of the VP for HELLO. The default returns the features the library implements for every VP (CAPABILITIES_LIBRARY), a VP adds the ones that depend on it, for example CAPABILITY_RUN_BUDGET if it calls check_run_budget.
+            virtual status handle_get_capabilities(uint32_t &capabilities);
+
+            // Virtual function to handle a SNAPSHOT_CREATE command. The default stores the CPU registers and creates a snapshot of the registered guest memory regions. A VP with additional state (peripherals, PC, simulation time) should override this and call the default.
+            virtual status handle_snapshot_create();
+
+            // Virtual function to handle a SNAPSHOT_RESTORE command. The default restores the CPU registers and copies back the guest memory pages that were written since the snapshot. The number of restored pages is written to restored_pages.
+            virtual status handle_snapshot_restore(uint32_t &restored_pages);
+
             // Singleton reference
             static testing_receiver* m_instance;
 
@@ -202,16 +438,170 @@ namespace testing{
             // Thread with the receiver loop.
             std::thread m_receiver_thread;
 
+            // Indicates that the receiver loop was started with start_receiver_in_thread.
+            bool m_receiver_in_thread = false;
+
             // Pointer to the communcation object used.
-            testing_communication* m_communication;
+            testing_communication* m_communication = nullptr;
 
             // Current active request and response.
             request m_current_req;
             response m_current_res;
 
-            // Array and pointer for code coverage tracking.
-            uint8_t m_bb_array [MAP_SIZE];
-            uint64_t m_prev_bb_loc = 0;
+            // Coverage state of one core (or simulation thread): coverage map and the tracker with the COVERAGE_POLICY.
+            struct coverage_shard{
+                coverage_map map;
+                coverage_tracker<COVERAGE_POLICY> tracker{map};
+            };
+
+            // Coverage shards are placed in anonymous shared memory, so the coverage of a forked child (FORK_SERVER) is visible to the parent.
+            struct coverage_shard_deleter{
+                void operator()(coverage_shard* shard) const;
+            };
+
+            using coverage_shard_ptr = std::unique_ptr<coverage_shard, coverage_shard_deleter>;
+
+            // Creates an empty coverage shard in anonymous shared memory, placed with the memory placement.
+            coverage_shard_ptr create_coverage_shard();
+
+            // Allocates the seen coverage, placed with the memory placement.
+            bool allocate_seen_coverage();
+
+            // Applies the memory placement to a buffer.
+            void place_buffer(void* start, size_t size);
+
+            // Return code of the last run of the fork server, written by the child (in anonymous shared memory), because the parent stays at the start breakpoint.
+            struct fork_server_state{
+                uint64_t return_code;
+                bool return_code_valid;
+            };
+
+            // Writes the merged coverage of all shards to dest (MAP_SIZE bytes).
+            void copy_coverage_to(uint8_t* dest);
+
+            // Prepares a new run by resetting the coverage (via handle_reset_code_coverage) and the run result.
+            void begin_run();
+
+            // Completes the run result after a run: captures the return code (via handle_get_return_code), the coverage hash and if the run found new coverage.
+            void complete_run();
+
+            // Completes the coverage part of the run result: coverage hash, new coverage and executed blocks.
+            void complete_run_coverage();
+
+            // Writes the current run result with the status of the run as a DO_RUN_BATCH record (RUN_BATCH_RECORD_SIZE bytes) to buffer.
+            void write_run_batch_record(char* buffer, status run_status);
+
+            // Starts a run of DO_RUN, DO_RUN_SHM, DO_RUN_POSIX_SHM or RUN_PREPARED, if the result record is enabled.
+            void begin_single_run();
+
+            // Completes a run of DO_RUN, DO_RUN_SHM, DO_RUN_POSIX_SHM or RUN_PREPARED and flushes the MMIO trace. Sets the response data to the result record, if enabled.
+            void complete_single_run(response &res);
+
+            // Sets the response data to the result record of the current run result.
+            void write_run_result_record(response &res);
+
+            // Executes a run of DO_RUN, DO_RUN_SHM, DO_RUN_POSIX_SHM or RUN_PREPARED with begin_single_run and complete_single_run. In fork server mode the run is executed in a forked child and the wait status of the child is appended to the response data.
+            void execute_single_run(response &res, const std::function<status()> &run);
+
+            // Runs work in a forked child and waits until it exits (or kills it after the fork server timeout). The output written by work is passed back through a pipe. Returns false if the child could not be forked.
+            bool run_in_fork_child(const std::function<void(std::vector<char>&)> &work, std::vector<char> &output, int &wait_status);
+
+            // Returns the start breakpoint that is passed to the run handlers. In fork server mode this is empty, because the VP already is at the start breakpoint of the FORK_SERVER command.
+            std::string run_start_breakpoint(const std::string &start_breakpoint) const;
+
+            // Applies the current sampling configuration to the tracker of a shard. Every shard gets its own seed derived from the configured seed.
+            void configure_shard_sampling(size_t shard);
+
+            // Coverage shards, at least one.
+            std::vector<coverage_shard_ptr> m_coverage_shards;
+
+            // Tracker of the first shard, so hit_block does not load the shard vector and the shard pointer. The first shard is created in the constructor and never replaced.
+            coverage_tracker<COVERAGE_POLICY>* m_primary_tracker = nullptr;
+
+            // Buffer for merging the shards, if more than one shard is used.
+            std::vector<uint8_t> m_merged_coverage;
+
+            // Coverage buckets seen by all previous runs, allocated on first use (shared with the children of the fork server).
+            anonymous_shared_memory m_seen_coverage;
+
+            // Coverage buckets seen by all runs of all VPs attached to it (see ATTACH_GLOBAL_COVERAGE).
+            posix_shm_region m_global_coverage;
+
+            // Result of the current (or last) run.
+            run_result m_run_result;
+
+            // Flags set by SET_RUN_OPTIONS.
+            uint8_t m_run_options = 0;
+
+            // Budget set by SET_RUN_BUDGET and if any limit is set.
+            run_budget m_run_budget;
+            bool m_run_budget_enabled = false;
+
+            // Limits of the current run as absolute values (UINT64_MAX for no limit), compared by check_run_budget. The block limit is for the block count of the first shard.
+            uint64_t m_instruction_limit = UINT64_MAX;
+            uint64_t m_simulation_time_limit = UINT64_MAX;
+            uint64_t m_block_limit = UINT64_MAX;
+
+            // Calls of check_run_budget until the next periodic check, and if the budget of the current run is exhausted.
+            uint32_t m_run_budget_countdown = RUN_BUDGET_CHECK_STRIDE;
+            bool m_run_budget_exhausted = false;
+
+            // Start of the current run on the monotonic clock in nanoseconds and the block count of all shards at the start.
+            uint64_t m_run_start_time = 0;
+            uint64_t m_run_start_blocks = 0;
+
+            // Hit entries of all shards at the last periodic check and the block count when they last increased (loop detection).
+            size_t m_run_hit_entries = 0;
+            uint64_t m_run_progress_blocks = 0;
+
+            // Sampling configuration of the coverage trackers (period in blocks or nanoseconds).
+            coverage_sampling m_coverage_sampling = SAMPLE_ALL;
+            uint64_t m_coverage_sample_period = 1;
+            uint32_t m_coverage_sample_seed = 0;
+
+            // Mapped input region of DO_RUN_POSIX_SHM, the sequence number of the last input and if the current input is reused.
+            posix_shm_region m_input_region;
+            uint64_t m_input_sequence = UINT64_MAX;
+            bool m_input_reused = false;
+
+            // Writer and shared memory of the MMIO trace.
+            mmio_trace_writer m_mmio_trace;
+            sysv_shm_segment m_mmio_trace_segment;
+
+            // Push channel of the events and its shared memory.
+            event_push_channel m_event_push;
+            sysv_shm_segment m_event_push_segment;
+
+            // Outcome of the HELLO negotiation: version and capabilities of the client, version 0 without HELLO.
+            protocol_info m_client_protocol;
+
+            // Tracked MMIO ranges of the default range handlers.
+            mmio_range_index m_mmio_tracking_ranges;
+
+            // Fixed reads of the default handlers.
+            fixed_read_table m_fixed_reads;
+
+            // MMIO read queue of the default handle_add_to_mmio_read_queue.
+            mmio_read_queue m_mmio_read_queue;
+
+            // Runs registered with PREPARE_RUN, the handle is the index.
+            std::vector<prepared_run> m_prepared_runs;
+
+            // Snapshot of the registered guest memory regions.
+            memory_snapshot m_memory_snapshot;
+
+            // Placement of the receiver and the simulation thread.
+            thread_placement m_receiver_placement;
+            thread_placement m_simulation_placement;
+
+            // NUMA node (-1 for no placement) and huge pages of the shared buffers.
+            int m_memory_node = -1;
+            bool m_huge_pages = false;
+
+            // Fork server mode, the timeout of a child and the state shared with the children.
+            bool m_fork_server = false;
+            uint32_t m_fork_server_timeout_ms = 0;
+            anonymous_shared_memory m_fork_server_state;
     };
 
 }
@@ -0,0 +1,52 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TESTING_THREAD_PLACEMENT_H
+#define TESTING_THREAD_PLACEMENT_H
+
+#include <cstddef>
+#include <vector>
+
+namespace testing{
+
+    // Placement of a thread. The receiver thread and the simulation thread exchange every event via semaphores, so they should run on the same core (or SMT siblings) and on the node of the shared buffers.
+    struct thread_placement{
+        // CPUs the thread may run on, empty to keep the current affinity.
+        std::vector<int> cpus;
+
+        // Scheduling policy (SCHED_OTHER, SCHED_BATCH, SCHED_IDLE, SCHED_FIFO or SCHED_RR) and its priority, -1 to keep the current policy. The real-time policies need CAP_SYS_NICE.
+        int policy = -1;
+        int priority = 0;
+    };
+
+    // Applies the placement to the calling thread. Returns false on failure, errno is set accordingly.
+    bool apply_thread_placement(const thread_placement &placement);
+
+    // Returns the NUMA node of a CPU, -1 if it is unknown.
+    int numa_node_of_cpu(int cpu);
+
+    // Returns the NUMA node the calling thread currently runs on, -1 if it is unknown.
+    int current_numa_node();
+
+    // Places the pages of a memory range (extended to page boundaries) on a NUMA node (-1 to keep the placement) and enables transparent huge pages for it. Pages that already exist are moved, new pages are allocated on the node if it has free memory. Returns false on failure, errno is set accordingly.
+    bool place_memory(void* start, size_t size, int numa_node, bool huge_pages);
+}
+
+#endif
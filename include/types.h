@@ -20,11 +20,53 @@
 #ifndef TESTING_TYPES_H
 #define TESTING_TYPES_H
 
+#include <cstdint>
+#include <string>
+
 #define MQ_MAX_LENGTH 256
 #define MQ_MAX_MSG 10
 
 #define PIPE_READ_ERROR_MAX 5
 
+// Size of one result record of DO_RUN_BATCH.
+#define RUN_BATCH_RECORD_SIZE 24
+
+// Size of the result record appended to the DO_RUN, DO_RUN_SHM, DO_RUN_POSIX_SHM and RUN_PREPARED responses.
+#define RUN_RESULT_RECORD_SIZE 48
+
+// Number of calls of testing_receiver::check_run_budget between two checks of the wall time, the blocks of all shards and the loop detection.
+#define RUN_BUDGET_CHECK_STRIDE 64
+
+// Flags of SET_RUN_OPTIONS.
+#define RUN_OPTION_RESULT_RECORD 0x01
+
+// Version of the protocol, exchanged with HELLO. A VP or client without HELLO has version 0.
+#define PROTOCOL_VERSION 1
+
+// Capabilities exchanged with HELLO, the optional features that a VP supports.
+#define CAPABILITY_RESULT_RECORD 0x00000001     // SET_RUN_OPTIONS with the result record.
+#define CAPABILITY_RUN_BATCH 0x00000002         // DO_RUN_BATCH.
+#define CAPABILITY_SHM_COVERAGE 0x00000004      // GET_CODE_COVERAGE_SHM.
+#define CAPABILITY_POSIX_SHM_INPUT 0x00000008   // DO_RUN_POSIX_SHM.
+#define CAPABILITY_PREPARED_RUN 0x00000010      // PREPARE_RUN and RUN_PREPARED, the VP resolves the symbols once in handle_prepare_run.
+#define CAPABILITY_GLOBAL_COVERAGE 0x00000020   // ATTACH_GLOBAL_COVERAGE.
+#define CAPABILITY_EVENT_PUSH 0x00000040        // ENABLE_EVENT_PUSH.
+#define CAPABILITY_MMIO_RANGES 0x00000080       // ADD_MMIO_TRACKING_RANGE and SET_FIXED_READ_WIDE.
+#define CAPABILITY_MMIO_TRACE 0x00000100        // ENABLE_MMIO_TRACE, the VP calls trace_mmio_access.
+#define CAPABILITY_SNAPSHOTS 0x00000200         // SNAPSHOT_CREATE, SNAPSHOT_RESTORE and PERSISTENT_RUN.
+#define CAPABILITY_FORK_SERVER 0x00000400       // FORK_SERVER, the simulation runs in the receiver thread.
+#define CAPABILITY_RUN_BUDGET 0x00000800        // SET_RUN_BUDGET, the VP calls check_run_budget.
+#define CAPABILITY_NATIVE_BYTE_ORDER 0x00001000 // Integers after HELLO in the native byte order of the host instead of big endian.
+
+// Capabilities that the library implements for every VP.
+#define CAPABILITIES_LIBRARY (CAPABILITY_RESULT_RECORD | CAPABILITY_RUN_BATCH | CAPABILITY_SHM_COVERAGE | CAPABILITY_POSIX_SHM_INPUT | CAPABILITY_GLOBAL_COVERAGE | CAPABILITY_EVENT_PUSH | CAPABILITY_MMIO_RANGES | CAPABILITY_NATIVE_BYTE_ORDER)
+
+// All known capabilities.
+#define CAPABILITIES_ALL 0x00001FFF
+
+// Capabilities that a client requests by default. The native byte order changes the encoding of every request, so a client has to request it explicitly.
+#define CAPABILITIES_DEFAULT (CAPABILITIES_ALL & ~CAPABILITY_NATIVE_BYTE_ORDER)
+
 namespace testing{
 
     // Types of interface that exists.
@@ -34,7 +76,7 @@ namespace testing{
 
     // Possible commands.
     enum command{
-        CONTINUE, KILL, SET_BREAKPOINT, REMOVE_BREAKPOINT, ENABLE_MMIO_TRACKING, DISABLE_MMIO_TRACKING, SET_MMIO_VALUE, ADD_TO_MMIO_READ_QUEUE, SET_CPU_INTERRUPT_TRIGGER, ENABLE_CODE_COVERAGE, DISABLE_CODE_COVERAGE, GET_CODE_COVERAGE, GET_CODE_COVERAGE_SHM, RESET_CODE_COVERAGE, SET_RETURN_CODE_ADDRESS, GET_RETURN_CODE, DO_RUN, DO_RUN_SHM, SET_ERROR_SYMBOL, SET_FIXED_READ, GET_CPU_PC, JUMP_CPU_TO, STORE_CPU_REGISTERS, RESTORE_CPU_REGISTERS 
+        CONTINUE, KILL, SET_BREAKPOINT, REMOVE_BREAKPOINT, ENABLE_MMIO_TRACKING, DISABLE_MMIO_TRACKING, SET_MMIO_VALUE, ADD_TO_MMIO_READ_QUEUE, SET_CPU_INTERRUPT_TRIGGER, ENABLE_CODE_COVERAGE, DISABLE_CODE_COVERAGE, GET_CODE_COVERAGE, GET_CODE_COVERAGE_SHM, RESET_CODE_COVERAGE, SET_RETURN_CODE_ADDRESS, GET_RETURN_CODE, DO_RUN, DO_RUN_SHM, SET_ERROR_SYMBOL, SET_FIXED_READ, GET_CPU_PC, JUMP_CPU_TO, STORE_CPU_REGISTERS, RESTORE_CPU_REGISTERS, SET_CODE_COVERAGE_SAMPLING, DO_RUN_BATCH, SNAPSHOT_CREATE, SNAPSHOT_RESTORE, PERSISTENT_RUN, PREPARE_RUN, RUN_PREPARED, SET_RUN_OPTIONS, ADD_MMIO_TRACKING_RANGE, REMOVE_MMIO_TRACKING_RANGE, SET_FIXED_READ_WIDE, ENABLE_MMIO_TRACE, DISABLE_MMIO_TRACE, DO_RUN_POSIX_SHM, FORK_SERVER, ATTACH_GLOBAL_COVERAGE, SET_RUN_BUDGET, ENABLE_EVENT_PUSH, DISABLE_EVENT_PUSH, HELLO
     };
 
     // Possible return status codes.
@@ -44,7 +86,7 @@ namespace testing{
 
     // Possible events that the simulation can produce.
     enum event_type{
-        MMIO_READ, MMIO_WRITE, VP_END, BREAKPOINT_HIT, ERROR_SYMBOL_HIT, VP_ERROR
+        MMIO_READ, MMIO_WRITE, VP_END, BREAKPOINT_HIT, ERROR_SYMBOL_HIT, VP_ERROR, HANG
     };
 
     struct event{
@@ -53,6 +95,73 @@ namespace testing{
         uint32_t additional_data_length = 0;
     };
     
+    // Result of one run (DO_RUN and similar commands), collected by the testing_receiver.
+    struct run_result{
+        // Captured return code (see SET_RETURN_CODE_ADDRESS).
+        uint64_t return_code = 0;
+
+        // Event that terminated the run, reported by the VP. VP_END if the end breakpoint was reached.
+        event_type end_event = VP_END;
+
+        // Hash of the bucketed coverage map of the run.
+        uint64_t coverage_hash = 0;
+
+        // Indicates that the run hit coverage buckets that no previous run hit.
+        bool new_coverage = false;
+
+        // Indicates that the run set buckets in the global coverage (see ATTACH_GLOBAL_COVERAGE) that no run of any VP set before.
+        bool new_global_coverage = false;
+
+        // Number of executed blocks, counted by the coverage trackers of all shards.
+        uint64_t block_count = 0;
+
+        // Number of executed instructions and simulated time in picoseconds, reported by the VP.
+        uint64_t instruction_count = 0;
+        uint64_t simulation_time = 0;
+    };
+
+    // Limits of a run (see SET_RUN_BUDGET), 0 means no limit. A run that exhausts one of them ends with the event HANG.
+    struct run_budget{
+        // Executed instructions and simulated time in picoseconds, as passed to testing_receiver::check_run_budget.
+        uint64_t instructions = 0;
+        uint64_t simulation_time = 0;
+
+        // Executed blocks, counted by the coverage trackers of all shards.
+        uint64_t blocks = 0;
+
+        // Host wall time in microseconds.
+        uint64_t wall_time = 0;
+
+        // Number of executed blocks without a coverage map entry that was not hit before in this run, so the run most likely repeats a loop.
+        uint64_t stall_blocks = 0;
+    };
+
+    // Outcome of the HELLO negotiation. The capabilities are the ones that the VP and the client both support.
+    struct protocol_info{
+        uint32_t version = 0;
+        uint32_t capabilities = 0;
+
+        // Maximum data length of a request or response.
+        uint32_t max_message_size = 0;
+
+        // Size of the coverage map of the VP in bytes.
+        uint32_t coverage_map_size = 0;
+    };
+
+    // Parameters of a run registered with PREPARE_RUN. The VP resolves the symbols and the register once in handle_prepare_run and stores the results, so RUN_PREPARED needs no string parsing or symbol lookup.
+    struct prepared_run{
+        std::string start_breakpoint;
+        std::string end_breakpoint;
+        std::string register_name;
+        uint64_t mmio_address = 0;
+        size_t mmio_length = 0;
+
+        // Resolved by the VP, for example the addresses of the breakpoint symbols and the index of the return register.
+        uint64_t start_address = 0;
+        uint64_t end_address = 0;
+        int64_t register_id = -1;
+    };
+
     // Represents a request send to the implemented testing interface with a command ID and flexible length data.
     struct request{
         command request_command;
@@ -0,0 +1,116 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "event_push.h"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <climits>
+#include <cstring>
+#include <thread>
+
+namespace testing{
+
+    bool event_push_channel::attach(char* memory, size_t size, uint32_t event_mask, std::atomic<uint32_t>* wakeup){
+        detach();
+
+        if(!m_ring.attach(memory, size)) return false;
+
+        m_wakeup = wakeup;
+        m_event_mask = event_mask;
+        m_sequence = 0;
+        m_dropped = 0;
+        m_attached.store(true, std::memory_order_release);
+
+        return true;
+    }
+
+    void event_push_channel::detach(){
+        m_attached.store(false, std::memory_order_release);
+
+        // Waits for a push in progress, afterwards no push accesses the ring until the next attach, so the memory can be unmapped.
+        while(m_pushing.test_and_set(std::memory_order_acquire)){
+            std::this_thread::yield();
+        }
+
+        m_wakeup = nullptr;
+        m_pushing.clear(std::memory_order_release);
+    }
+
+    bool event_push_channel::push(event_type type, const char* data, uint32_t data_length, uint64_t timestamp){
+        uint64_t sequence = m_sequence.fetch_add(1, std::memory_order_relaxed);
+
+        // Never wait for another producer, it may be the thread that a signal handler (notify_VP_ERROR_event) interrupted.
+        if(m_pushing.test_and_set(std::memory_order_acquire)){
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // The channel may have been detached since is_pushed was checked.
+        if(!m_attached.load(std::memory_order_acquire)){
+            m_pushing.clear(std::memory_order_release);
+            return false;
+        }
+
+        pushed_event record;
+        record.sequence = sequence;
+        record.timestamp = timestamp;
+        record.event = (uint8_t)type;
+        memset(record.reserved, 0, sizeof(record.reserved));
+        record.data_length = data_length;
+
+        uint32_t copied_length = data_length < EVENT_PUSH_MAX_DATA ? data_length : EVENT_PUSH_MAX_DATA;
+        if(copied_length != 0) memcpy(record.data, data, copied_length);
+
+        bool pushed = m_ring.push(reinterpret_cast<const char*>(&record), EVENT_PUSH_HEADER_SIZE + copied_length);
+
+        // The wakeup word is in the same memory, so it is only touched while pushing.
+        if(pushed && m_wakeup != nullptr){
+            m_wakeup->fetch_add(1, std::memory_order_release);
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(m_wakeup), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+
+        m_pushing.clear(std::memory_order_release);
+
+        if(!pushed){
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        return true;
+    }
+
+    uint64_t event_push_channel::get_dropped() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    uint32_t event_push_channel::wait(std::atomic<uint32_t>* wakeup, uint32_t last_value, uint32_t timeout_ms){
+        struct timespec timeout = {(time_t)(timeout_ms / 1000), (long)(timeout_ms % 1000) * 1000000};
+
+        // A spurious wakeup or a signal returns early, the caller compares the value anyway.
+        if(wakeup->load(std::memory_order_acquire) == last_value){
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(wakeup), FUTEX_WAIT, last_value, timeout_ms != 0 ? &timeout : nullptr, nullptr, 0);
+        }
+
+        return wakeup->load(std::memory_order_acquire);
+    }
+}
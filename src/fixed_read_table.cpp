@@ -0,0 +1,83 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "fixed_read_table.h"
+
+#include <algorithm>
+
+namespace testing{
+
+    fixed_read_table::fixed_read_table(){
+        m_addresses.resize(16);
+        m_values.resize(16);
+        m_widths.resize(16, 0);
+    }
+
+    bool fixed_read_table::set(uint64_t address, const char* value, size_t width){
+        if(width == 0 || width > sizeof(uint64_t)) return false;
+
+        uint64_t stored_value = 0;
+        memcpy(&stored_value, value, width);
+
+        // Grow the table, so at most half of the slots are used.
+        if((m_count + 1) * 2 > m_widths.size()){
+            std::vector<uint64_t> old_addresses(m_widths.size() * 2);
+            std::vector<uint64_t> old_values(m_widths.size() * 2);
+            std::vector<uint8_t> old_widths(m_widths.size() * 2, 0);
+            old_addresses.swap(m_addresses);
+            old_values.swap(m_values);
+            old_widths.swap(m_widths);
+
+            m_count = 0;
+            for(size_t i = 0; i < old_widths.size(); i++){
+                if(old_widths[i] != 0) insert(old_addresses[i], old_values[i], old_widths[i]);
+            }
+        }
+
+        insert(address, stored_value, (uint8_t)width);
+
+        uint64_t filter_bit = filter_index(address);
+        m_filter[filter_bit / 64] |= 1ULL << (filter_bit % 64);
+
+        return true;
+    }
+
+    void fixed_read_table::clear(){
+        std::fill(m_widths.begin(), m_widths.end(), 0);
+        m_count = 0;
+        memset(m_filter, 0, sizeof(m_filter));
+    }
+
+    size_t fixed_read_table::size() const {
+        return m_count;
+    }
+
+    void fixed_read_table::insert(uint64_t address, uint64_t value, uint8_t width){
+        size_t mask = m_widths.size() - 1;
+        size_t slot = slot_of(address);
+
+        while(m_widths[slot] != 0 && m_addresses[slot] != address) slot = (slot + 1) & mask;
+
+        if(m_widths[slot] == 0) m_count++;
+
+        m_addresses[slot] = address;
+        m_values[slot] = value;
+        m_widths[slot] = width;
+    }
+}
@@ -0,0 +1,319 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "memory_snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+// Soft-dirty bit of a /proc/self/pagemap entry.
+#define PAGEMAP_SOFT_DIRTY (1ULL << 55)
+
+// Number of pagemap entries read at once.
+#define PAGEMAP_CHUNK 512
+
+namespace testing{
+
+    std::atomic<memory_snapshot::region*> memory_snapshot::s_tracked_regions[SNAPSHOT_MAX_TRACKED_REGIONS];
+    struct sigaction memory_snapshot::s_previous_handler;
+    bool memory_snapshot::s_handler_installed = false;
+
+    static const size_t s_page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    memory_snapshot::memory_snapshot(dirty_page_tracking tracking):m_tracking(tracking){}
+
+    memory_snapshot::~memory_snapshot(){
+        discard();
+        if(m_pagemap_fd != -1) close(m_pagemap_fd);
+    }
+
+    bool memory_snapshot::set_tracking(dirty_page_tracking tracking){
+        if(m_created) return false;
+
+        m_tracking = tracking;
+        return true;
+    }
+
+    bool memory_snapshot::add_region(void* start, size_t size){
+        if(m_created || start == nullptr || size == 0) return false;
+
+        // Extend the region to page boundaries, because the protection and the dirty bits work on pages.
+        uintptr_t first = (uintptr_t)start & ~(uintptr_t)(s_page_size - 1);
+        uintptr_t last = ((uintptr_t)start + size + s_page_size - 1) & ~(uintptr_t)(s_page_size - 1);
+
+        auto new_region = std::make_unique<region>();
+        new_region->start = (char*)first;
+        new_region->size = last - first;
+        new_region->page_count = new_region->size / s_page_size;
+        new_region->dirty_pages = std::make_unique<uint32_t[]>(new_region->page_count);
+
+        m_regions.push_back(std::move(new_region));
+        return true;
+    }
+
+    bool memory_snapshot::create(){
+        if(m_regions.empty()) return false;
+
+        discard();
+
+        for(auto &tracked_region: m_regions){
+            tracked_region->copy.assign(tracked_region->start, tracked_region->start + tracked_region->size);
+            tracked_region->dirty_count = 0;
+        }
+
+        if(m_tracking == WRITE_PROTECT_TRACKING){
+            if(!install_fault_handler()) return false;
+
+            for(auto &tracked_region: m_regions){
+                if(!register_tracked_region(tracked_region.get()) || !protect_region(*tracked_region)){
+                    m_created = true;
+                    discard();
+                    return false;
+                }
+            }
+        }else{
+            // Without kernel support the pagemap reads succeed, but no page is ever reported as written.
+            if(m_pagemap_fd == -1){
+                m_pagemap_fd = open("/proc/self/pagemap", O_RDONLY);
+                if(m_pagemap_fd != -1 && !probe_soft_dirty()){
+                    close(m_pagemap_fd);
+                    m_pagemap_fd = -1;
+                }
+            }
+
+            if(m_pagemap_fd == -1 || !clear_soft_dirty()){
+                for(auto &tracked_region: m_regions) std::vector<char>().swap(tracked_region->copy);
+                return false;
+            }
+        }
+
+        m_created = true;
+        m_restored_pages = 0;
+        return true;
+    }
+
+    bool memory_snapshot::restore(){
+        if(!m_created) return false;
+
+        m_restored_pages = 0;
+        bool success = true;
+
+        for(auto &tracked_region: m_regions){
+            if(m_tracking == WRITE_PROTECT_TRACKING){
+                success &= restore_write_protected(*tracked_region);
+            }else{
+                success &= restore_soft_dirty(*tracked_region);
+            }
+        }
+
+        // The copying itself set the soft-dirty bits again.
+        if(m_tracking == SOFT_DIRTY_TRACKING) success &= clear_soft_dirty();
+
+        return success;
+    }
+
+    void memory_snapshot::discard(){
+        if(!m_created) return;
+
+        for(auto &tracked_region: m_regions){
+            if(m_tracking == WRITE_PROTECT_TRACKING){
+                unregister_tracked_region(tracked_region.get());
+                mprotect(tracked_region->start, tracked_region->size, PROT_READ | PROT_WRITE);
+            }
+
+            std::vector<char>().swap(tracked_region->copy);
+            tracked_region->dirty_count = 0;
+        }
+
+        m_created = false;
+    }
+
+    bool memory_snapshot::has_regions() const {
+        return !m_regions.empty();
+    }
+
+    bool memory_snapshot::has_snapshot() const {
+        return m_created;
+    }
+
+    size_t memory_snapshot::get_restored_page_count() const {
+        return m_restored_pages;
+    }
+
+    void memory_snapshot::handle_write_fault(int signal_number, siginfo_t* info, void* context){
+        char* address = (char*)info->si_addr;
+
+        for(size_t i = 0; i < SNAPSHOT_MAX_TRACKED_REGIONS; i++){
+            region* tracked_region = s_tracked_regions[i].load(std::memory_order_acquire);
+            if(tracked_region == nullptr || address < tracked_region->start || address >= tracked_region->start + tracked_region->size) continue;
+
+            // First write to this page since the last restore: unprotect and record it. The write is repeated when the handler returns.
+            size_t page = (size_t)(address - tracked_region->start) / s_page_size;
+            if(mprotect(tracked_region->start + page * s_page_size, s_page_size, PROT_READ | PROT_WRITE) != 0) break;
+
+            // Concurrent faults of multiple cores on the same page can record it twice. If this overflows the list, restore copies the whole region.
+            size_t slot = __atomic_fetch_add(&tracked_region->dirty_count, 1, __ATOMIC_RELAXED);
+            if(slot < tracked_region->page_count) tracked_region->dirty_pages[slot] = (uint32_t)page;
+
+            return;
+        }
+
+        // Not a tracked page, so this is a real fault of the VP.
+        if(s_previous_handler.sa_flags & SA_SIGINFO){
+            s_previous_handler.sa_sigaction(signal_number, info, context);
+        }else if(s_previous_handler.sa_handler != SIG_DFL && s_previous_handler.sa_handler != SIG_IGN){
+            s_previous_handler.sa_handler(signal_number);
+        }else{
+            // Restore the default action, the faulting instruction is executed again and terminates the process.
+            signal(signal_number, SIG_DFL);
+        }
+    }
+
+    bool memory_snapshot::install_fault_handler(){
+        if(s_handler_installed) return true;
+
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = handle_write_fault;
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+
+        if(sigaction(SIGSEGV, &action, &s_previous_handler) != 0) return false;
+
+        s_handler_installed = true;
+        return true;
+    }
+
+    bool memory_snapshot::register_tracked_region(region* tracked_region){
+        for(size_t i = 0; i < SNAPSHOT_MAX_TRACKED_REGIONS; i++){
+            region* expected = nullptr;
+            if(s_tracked_regions[i].compare_exchange_strong(expected, tracked_region, std::memory_order_release)) return true;
+        }
+        return false;
+    }
+
+    void memory_snapshot::unregister_tracked_region(region* tracked_region){
+        for(size_t i = 0; i < SNAPSHOT_MAX_TRACKED_REGIONS; i++){
+            region* expected = tracked_region;
+            s_tracked_regions[i].compare_exchange_strong(expected, nullptr, std::memory_order_release);
+        }
+    }
+
+    bool memory_snapshot::protect_region(region &tracked_region){
+        return mprotect(tracked_region.start, tracked_region.size, PROT_READ) == 0;
+    }
+
+    bool memory_snapshot::restore_write_protected(region &tracked_region){
+        size_t dirty_count = __atomic_load_n(&tracked_region.dirty_count, __ATOMIC_ACQUIRE);
+
+        // The list overflowed, copy back the whole region.
+        if(dirty_count > tracked_region.page_count){
+            if(mprotect(tracked_region.start, tracked_region.size, PROT_READ | PROT_WRITE) != 0) return false;
+            memcpy(tracked_region.start, tracked_region.copy.data(), tracked_region.size);
+            tracked_region.dirty_count = 0;
+            m_restored_pages += tracked_region.page_count;
+            return protect_region(tracked_region);
+        }
+
+        // Sort the written pages, so consecutive pages are copied and protected with one call.
+        uint32_t* pages = tracked_region.dirty_pages.get();
+        std::sort(pages, pages + dirty_count);
+        dirty_count = std::unique(pages, pages + dirty_count) - pages;
+
+        bool success = true;
+        size_t i = 0;
+        while(i < dirty_count){
+            size_t first = pages[i];
+            size_t last = first;
+            while(i + 1 < dirty_count && pages[i + 1] == last + 1){
+                last++;
+                i++;
+            }
+            i++;
+
+            size_t offset = first * s_page_size;
+            size_t length = (last - first + 1) * s_page_size;
+            memcpy(tracked_region.start + offset, tracked_region.copy.data() + offset, length);
+            success &= mprotect(tracked_region.start + offset, length, PROT_READ) == 0;
+        }
+
+        tracked_region.dirty_count = 0;
+        m_restored_pages += dirty_count;
+        return success;
+    }
+
+    bool memory_snapshot::restore_soft_dirty(region &tracked_region){
+        uint64_t entries[PAGEMAP_CHUNK];
+        size_t first_page = (uintptr_t)tracked_region.start / s_page_size;
+
+        for(size_t chunk = 0; chunk < tracked_region.page_count; chunk += PAGEMAP_CHUNK){
+            size_t count = std::min<size_t>(PAGEMAP_CHUNK, tracked_region.page_count - chunk);
+            ssize_t length = pread(m_pagemap_fd, entries, count * sizeof(uint64_t), (first_page + chunk) * sizeof(uint64_t));
+            if(length != (ssize_t)(count * sizeof(uint64_t))) return false;
+
+            // Copy runs of consecutive soft-dirty pages.
+            size_t i = 0;
+            while(i < count){
+                if(!(entries[i] & PAGEMAP_SOFT_DIRTY)){
+                    i++;
+                    continue;
+                }
+
+                size_t first = i;
+                while(i < count && (entries[i] & PAGEMAP_SOFT_DIRTY)) i++;
+
+                size_t offset = (chunk + first) * s_page_size;
+                memcpy(tracked_region.start + offset, tracked_region.copy.data() + offset, (i - first) * s_page_size);
+                m_restored_pages += i - first;
+            }
+        }
+
+        return true;
+    }
+
+    bool memory_snapshot::clear_soft_dirty(){
+        int fd = open("/proc/self/clear_refs", O_WRONLY);
+        if(fd == -1) return false;
+
+        // "4" clears the soft-dirty bits of all pages of the process.
+        bool success = write(fd, "4", 1) == 1;
+        close(fd);
+
+        return success;
+    }
+
+    bool memory_snapshot::probe_soft_dirty(){
+        char* page = (char*)mmap(nullptr, s_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(page == MAP_FAILED) return false;
+
+        uint64_t entry = 0;
+        page[0] = 1;
+        bool success = clear_soft_dirty();
+        page[0] = 2;
+
+        success &= pread(m_pagemap_fd, &entry, sizeof(entry), ((uintptr_t)page / s_page_size) * sizeof(entry)) == sizeof(entry);
+        munmap(page, s_page_size);
+
+        return success && (entry & PAGEMAP_SOFT_DIRTY);
+    }
+}
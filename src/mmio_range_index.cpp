@@ -0,0 +1,82 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "mmio_range_index.h"
+
+#include <algorithm>
+
+namespace testing{
+
+    bool mmio_range_index::add(uint32_t id, uint64_t start_address, uint64_t end_address, mmio_tracking_mode mode){
+        if(start_address > end_address) return false;
+        if(std::find(m_ids.begin(), m_ids.end(), id) != m_ids.end()) return false;
+
+        size_t index = std::upper_bound(m_starts.begin(), m_starts.end(), start_address) - m_starts.begin();
+
+        // Overlap with the previous or the next range.
+        if(index > 0 && m_ends[index - 1] >= start_address) return false;
+        if(index < m_starts.size() && m_starts[index] <= end_address) return false;
+
+        m_starts.insert(m_starts.begin() + index, start_address);
+        m_ends.insert(m_ends.begin() + index, end_address);
+        m_ids.insert(m_ids.begin() + index, id);
+        m_modes.insert(m_modes.begin() + index, mode);
+
+        update_bounds();
+        return true;
+    }
+
+    bool mmio_range_index::remove(uint32_t id){
+        auto it = std::find(m_ids.begin(), m_ids.end(), id);
+        if(it == m_ids.end()) return false;
+
+        size_t index = it - m_ids.begin();
+        m_starts.erase(m_starts.begin() + index);
+        m_ends.erase(m_ends.begin() + index);
+        m_ids.erase(m_ids.begin() + index);
+        m_modes.erase(m_modes.begin() + index);
+
+        update_bounds();
+        return true;
+    }
+
+    void mmio_range_index::clear(){
+        m_starts.clear();
+        m_ends.clear();
+        m_ids.clear();
+        m_modes.clear();
+
+        update_bounds();
+    }
+
+    size_t mmio_range_index::size() const {
+        return m_starts.size();
+    }
+
+    void mmio_range_index::update_bounds(){
+        if(m_starts.empty()){
+            m_min_address = UINT64_MAX;
+            m_max_address = 0;
+            return;
+        }
+
+        m_min_address = m_starts.front();
+        m_max_address = m_ends.back();
+    }
+}
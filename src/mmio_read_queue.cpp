@@ -0,0 +1,137 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "mmio_read_queue.h"
+
+#include <algorithm>
+
+namespace testing{
+
+    mmio_read_queue::mmio_read_queue(size_t address_capacity){
+        size_t size = 2;
+        while(size < address_capacity * 2) size *= 2;
+        m_entries.resize(size);
+    }
+
+    void mmio_read_queue::push(uint64_t address, const char* data, size_t length){
+        if(length == 0) return;
+
+        entry &queue = find_or_insert(address);
+        make_owned(queue, length);
+
+        memcpy(queue.buffer.data() + queue.tail, data, length);
+        queue.tail += length;
+        m_queued_bytes += length;
+    }
+
+    void mmio_read_queue::push_view(uint64_t address, const char* data, size_t length){
+        if(length == 0) return;
+
+        entry &queue = find_or_insert(address);
+        if(queue.head != queue.tail){
+            push(address, data, length);
+            return;
+        }
+
+        queue.data = data;
+        queue.head = 0;
+        queue.tail = length;
+        m_queued_bytes += length;
+    }
+
+    size_t mmio_read_queue::available(uint64_t address) const {
+        size_t slot = slot_of(address);
+        while(m_entries[slot].used){
+            if(m_entries[slot].address == address) return m_entries[slot].tail - m_entries[slot].head;
+            slot = (slot + 1) & (m_entries.size() - 1);
+        }
+        return 0;
+    }
+
+    void mmio_read_queue::clear(uint64_t address){
+        entry* queue = find(address);
+        if(queue == nullptr) return;
+
+        m_queued_bytes -= queue->tail - queue->head;
+        queue->head = 0;
+        queue->tail = 0;
+        queue->data = queue->buffer.data();
+    }
+
+    void mmio_read_queue::clear(){
+        for(entry &queue: m_entries){
+            queue.head = 0;
+            queue.tail = 0;
+            queue.data = queue.buffer.data();
+        }
+        m_queued_bytes = 0;
+    }
+
+    mmio_read_queue::entry& mmio_read_queue::find_or_insert(uint64_t address){
+        entry* queue = find(address);
+        if(queue != nullptr) return *queue;
+
+        // Grow the table, so at most half of the slots are used.
+        if((m_used_entries + 1) * 2 > m_entries.size()){
+            std::vector<entry> old_entries(m_entries.size() * 2);
+            old_entries.swap(m_entries);
+
+            for(entry &old_entry: old_entries){
+                if(!old_entry.used) continue;
+
+                size_t slot = slot_of(old_entry.address);
+                while(m_entries[slot].used) slot = (slot + 1) & (m_entries.size() - 1);
+
+                // A moved buffer keeps its storage, so the data pointer stays valid.
+                m_entries[slot] = std::move(old_entry);
+            }
+        }
+
+        size_t slot = slot_of(address);
+        while(m_entries[slot].used) slot = (slot + 1) & (m_entries.size() - 1);
+
+        m_entries[slot].used = true;
+        m_entries[slot].address = address;
+        m_used_entries++;
+
+        return m_entries[slot];
+    }
+
+    void mmio_read_queue::make_owned(entry &queue, size_t additional_length){
+        size_t count = queue.tail - queue.head;
+
+        if(queue.data == queue.buffer.data()){
+            // Enough space behind the queued bytes.
+            if(queue.tail + additional_length <= queue.buffer.size()) return;
+
+            // Move the queued bytes to the start of the buffer.
+            if(queue.head != 0) memmove(queue.buffer.data(), queue.buffer.data() + queue.head, count);
+            if(count + additional_length > queue.buffer.size()) queue.buffer.resize(std::max(queue.buffer.size() * 2, count + additional_length));
+        }else{
+            // Copy the remaining bytes of the view.
+            std::vector<char> buffer(std::max(queue.buffer.size(), count + additional_length));
+            memcpy(buffer.data(), queue.data + queue.head, count);
+            queue.buffer.swap(buffer);
+        }
+
+        queue.data = queue.buffer.data();
+        queue.head = 0;
+        queue.tail = count;
+    }
+}
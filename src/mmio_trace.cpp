@@ -0,0 +1,252 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "mmio_trace.h"
+
+namespace testing{
+
+    // Appends value as unsigned LEB128 varint.
+    static size_t write_varint(char* buffer, uint64_t value){
+        size_t length = 0;
+        while(value >= 0x80){
+            buffer[length++] = (char)(value | 0x80);
+            value >>= 7;
+        }
+        buffer[length++] = (char)value;
+        return length;
+    }
+
+    // Reads an unsigned LEB128 varint. Returns false if the buffer ends or the varint is too long.
+    static bool read_varint(const char* buffer, size_t length, size_t &offset, uint64_t &value){
+        value = 0;
+        for(unsigned shift = 0; shift < 64; shift += 7){
+            if(offset >= length) return false;
+
+            uint8_t byte = buffer[offset++];
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if(!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    static inline uint64_t zigzag_encode(uint64_t difference){
+        return (difference << 1) ^ (uint64_t)((int64_t)difference >> 63);
+    }
+
+    static inline uint64_t zigzag_decode(uint64_t value){
+        return (value >> 1) ^ (0 - (value & 1));
+    }
+
+    bool mmio_trace_ring::init(char* memory, size_t size){
+        if(memory == nullptr || size < MMIO_TRACE_HEADER_SIZE + sizeof(mmio_trace_record)) return false;
+
+        uint64_t capacity = 1;
+        while((capacity * 2) * sizeof(mmio_trace_record) <= size - MMIO_TRACE_HEADER_SIZE) capacity *= 2;
+
+        m_header = reinterpret_cast<mmio_trace_header*>(memory);
+        m_records = reinterpret_cast<mmio_trace_record*>(memory + MMIO_TRACE_HEADER_SIZE);
+        m_header->capacity = capacity;
+        m_header->dropped.store(0, std::memory_order_relaxed);
+        m_header->tail.store(0, std::memory_order_relaxed);
+        m_header->head.store(0, std::memory_order_release);
+
+        return true;
+    }
+
+    bool mmio_trace_ring::attach(char* memory, size_t size){
+        if(memory == nullptr || size < MMIO_TRACE_HEADER_SIZE) return false;
+
+        mmio_trace_header* header = reinterpret_cast<mmio_trace_header*>(memory);
+        uint64_t capacity = header->capacity;
+        if(capacity == 0 || (capacity & (capacity - 1)) != 0 || capacity > (size - MMIO_TRACE_HEADER_SIZE) / sizeof(mmio_trace_record)) return false;
+
+        m_header = header;
+        m_records = reinterpret_cast<mmio_trace_record*>(memory + MMIO_TRACE_HEADER_SIZE);
+        return true;
+    }
+
+    bool mmio_trace_ring::push(const mmio_trace_record &record, mmio_trace_policy policy){
+        uint64_t capacity = m_header->capacity;
+        uint64_t head = m_header->head.load(std::memory_order_relaxed);
+        uint64_t tail = m_header->tail.load(std::memory_order_acquire);
+        uint32_t backoff_round = 0;
+
+        while(head - tail >= capacity){
+            if(policy == TRACE_DROP){
+                m_header->dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            if(policy == TRACE_OVERWRITE){
+                // Drop the oldest record. If the client removed it at the same time, the compare and swap fails and the ring has space.
+                if(m_header->tail.compare_exchange_strong(tail, tail + 1, std::memory_order_acq_rel)){
+                    m_header->dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                tail = m_header->tail.load(std::memory_order_acquire);
+                continue;
+            }
+
+            shm_ring_backoff(backoff_round);
+            tail = m_header->tail.load(std::memory_order_acquire);
+        }
+
+        m_records[head & (capacity - 1)] = record;
+        m_header->head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    bool mmio_trace_ring::pop(mmio_trace_record &record){
+        uint64_t capacity = m_header->capacity;
+        uint64_t tail = m_header->tail.load(std::memory_order_acquire);
+
+        while(tail != m_header->head.load(std::memory_order_acquire)){
+            record = m_records[tail & (capacity - 1)];
+
+            // If the tail was moved by the VP (overwrite), the copied record may be torn, try the new tail.
+            if(m_header->tail.compare_exchange_strong(tail, tail + 1, std::memory_order_acq_rel)) return true;
+        }
+
+        return false;
+    }
+
+    uint64_t mmio_trace_ring::get_dropped() const {
+        return m_header->dropped.load(std::memory_order_relaxed);
+    }
+
+    bool mmio_trace_writer::attach(char* memory, size_t size, mmio_trace_encoding encoding, mmio_trace_policy policy){
+        detach();
+
+        if(encoding == TRACE_DELTA){
+            // Variable size blocks cannot be overwritten in place.
+            if(policy == TRACE_OVERWRITE || !m_delta_ring.attach(memory, size)) return false;
+
+            m_block.reserve(MMIO_TRACE_BLOCK_RECORDS * MMIO_TRACE_MAX_DELTA_RECORD);
+            m_block_records = 0;
+        }else{
+            if(!m_fixed_ring.attach(memory, size)) return false;
+        }
+
+        m_encoding = encoding;
+        m_policy = policy;
+        m_attached = true;
+
+        return true;
+    }
+
+    void mmio_trace_writer::detach(){
+        if(!m_attached) return;
+
+        flush();
+        m_attached = false;
+    }
+
+    void mmio_trace_writer::append(const mmio_trace_record &record){
+        if(!m_attached) return;
+
+        if(m_encoding == TRACE_FIXED){
+            m_fixed_ring.push(record, m_policy);
+            return;
+        }
+
+        encode(record);
+        if(m_block_records == MMIO_TRACE_BLOCK_RECORDS) flush();
+    }
+
+    void mmio_trace_writer::flush(){
+        if(!m_attached || m_encoding != TRACE_DELTA || m_block_records == 0) return;
+
+        uint32_t length = (uint32_t)m_block.size();
+        uint32_t backoff_round = 0;
+
+        while(!m_delta_ring.push(m_block.data(), length)){
+            if(m_policy == TRACE_DROP){
+                m_dropped_blocks++;
+                break;
+            }
+            shm_ring_backoff(backoff_round);
+        }
+
+        m_block.clear();
+        m_block_records = 0;
+    }
+
+    uint64_t mmio_trace_writer::get_dropped_blocks() const {
+        return m_dropped_blocks;
+    }
+
+    void mmio_trace_writer::encode(const mmio_trace_record &record){
+        // The first record of a block is the keyframe.
+        if(m_block_records == 0){
+            m_block.clear();
+            m_previous = mmio_trace_record{};
+        }
+
+        char buffer[MMIO_TRACE_MAX_DELTA_RECORD];
+        size_t length = 1;
+
+        uint8_t flags = (record.write & 1) | (((record.width - 1) & 7) << 1);
+        if(m_block_records == 0 || record.range_id != m_previous.range_id){
+            flags |= 1 << 4;
+            length += write_varint(buffer + length, record.range_id);
+        }
+        buffer[0] = (char)flags;
+
+        length += write_varint(buffer + length, zigzag_encode(record.address - m_previous.address));
+        length += write_varint(buffer + length, zigzag_encode(record.timestamp - m_previous.timestamp));
+        length += write_varint(buffer + length, record.value);
+
+        m_block.insert(m_block.end(), buffer, buffer + length);
+        m_block_records++;
+        m_previous = record;
+    }
+
+    bool mmio_trace_writer::decode_block(const char* block, size_t length, std::vector<mmio_trace_record> &records){
+        mmio_trace_record previous = {};
+        size_t offset = 0;
+
+        while(offset < length){
+            uint8_t flags = block[offset++];
+
+            mmio_trace_record record = {};
+            record.write = flags & 1;
+            record.width = ((flags >> 1) & 7) + 1;
+            record.range_id = previous.range_id;
+
+            uint64_t value;
+            if(flags & (1 << 4)){
+                if(!read_varint(block, length, offset, value)) return false;
+                record.range_id = (uint32_t)value;
+            }
+
+            if(!read_varint(block, length, offset, value)) return false;
+            record.address = previous.address + zigzag_decode(value);
+
+            if(!read_varint(block, length, offset, value)) return false;
+            record.timestamp = previous.timestamp + zigzag_decode(value);
+
+            if(!read_varint(block, length, offset, record.value)) return false;
+
+            records.push_back(record);
+            previous = record;
+        }
+
+        return true;
+    }
+}
@@ -76,7 +76,7 @@ namespace testing{
             return false;
         }
 
-        char buffer[MQ_MAX_LENGTH];
+        char buffer[MQ_MAX_LENGTH+1];
 
         ssize_t bytes_read = mq_receive(m_mqt_responses, buffer, MQ_MAX_LENGTH, 0);
 
@@ -102,6 +102,9 @@ namespace testing{
 
             // Indicate ready.
             m_started = true;
+
+            if(m_negotiate) negotiate();
+
             return true;
         }
 
@@ -119,6 +122,11 @@ namespace testing{
         return true;
     }
 
+    uint32_t mq_testing_client::get_max_message_size(){
+        // Process ID and command (or status) are part of the message.
+        return MQ_MAX_LENGTH - sizeof(pid_t) - 1;
+    }
+
     bool mq_testing_client::send_request(request* req, response* res) {
 
         // Request structure:
@@ -161,10 +169,29 @@ namespace testing{
 
         ssize_t bytes_read = 0;
 
+        // Absolute deadline of the response timeout.
+        m_timed_out = false;
+        struct timespec deadline;
+        if(m_response_timeout_ms > 0){
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += m_response_timeout_ms / 1000;
+            deadline.tv_nsec += (m_response_timeout_ms % 1000) * 1000000L;
+            if(deadline.tv_nsec >= 1000000000L){
+                deadline.tv_sec ++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+        }
+
         do{
             // Waiting for a message and writing it to the same buffer.
-            bytes_read = mq_receive(m_mqt_responses, buffer, MQ_MAX_LENGTH, NULL);
+            if(m_response_timeout_ms > 0){
+                bytes_read = mq_timedreceive(m_mqt_responses, buffer, MQ_MAX_LENGTH, NULL, &deadline);
+            }else{
+                bytes_read = mq_receive(m_mqt_responses, buffer, MQ_MAX_LENGTH, NULL);
+            }
+
             if (bytes_read == -1) {
+                m_timed_out = errno == ETIMEDOUT;
                 log_error_message("Error receiving message: %s", strerror(errno));
                 return false;
             }
@@ -168,4 +168,9 @@ namespace testing{
 
         return true;
     }
+
+    uint32_t mq_testing_communication::get_max_message_size(){
+        // Process ID and status (or command) are part of the message.
+        return MQ_MAX_LENGTH - sizeof(pid_t) - 1;
+    }
 };
\ No newline at end of file
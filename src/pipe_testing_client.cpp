@@ -19,6 +19,8 @@
 
 #include "testing_client.h"
 
+#include <poll.h>
+
 namespace testing{
 
     pipe_testing_client::pipe_testing_client(){
@@ -58,6 +60,21 @@ namespace testing{
         }
 
         if(m_specific_fds){
+            // Move all pipe ends above the specific fds, otherwise dup2 could replace one of them (or an end of another client).
+            int minimum_fd = std::max(m_request_fd, m_response_fd) + 1;
+            for(int* fd: {&m_request_pipe[0], &m_request_pipe[1], &m_response_pipe[0], &m_response_pipe[1]}){
+                if(*fd >= minimum_fd) continue;
+
+                int moved_fd = fcntl(*fd, F_DUPFD, minimum_fd);
+                if(moved_fd == -1){
+                    log_error_message("Error moving the pipe file descriptors: %s", strerror(errno));
+                    return false;
+                }
+
+                close(*fd);
+                *fd = moved_fd;
+            }
+
             if(dup2(m_request_pipe[0], m_request_fd)  == -1 || dup2(m_response_pipe[1], m_response_fd) == -1){
                 log_error_message("Error setting file descriptor of pipes: %s", strerror(errno));
                 return false;
@@ -83,7 +100,7 @@ namespace testing{
             return false;
         }
 
-        char buffer[6];
+        char buffer[7];
 
         ssize_t bytes_read = read(m_response_pipe[0], buffer, 6);
 
@@ -99,6 +116,9 @@ namespace testing{
 
             // Indicate ready.
             m_started = true;
+
+            if(m_negotiate) negotiate();
+
             return true;
         }
 
@@ -138,7 +158,7 @@ namespace testing{
 
         // Copy command and data length into one buffer.
         buffer[0] = req->request_command;
-        testing_communication::int32_to_bytes(req->data_length, buffer, 1);
+        store_uint32(req->data_length, buffer + 1, BYTE_ORDER_BIG_ENDIAN);
 
         // Send this buffer.
         ssize_t written = write(m_request_pipe[1], buffer, sizeof(uint32_t)+1);
@@ -156,6 +176,22 @@ namespace testing{
 
         log_info_message("SENT: %d with length %d.", req->request_command, req->data_length);
 
+        // Wait until the response arrives or the timeout expires. A closed pipe (crashed VP) also wakes up the poll and fails the read below.
+        m_timed_out = false;
+        if(m_response_timeout_ms > 0){
+            struct pollfd response_poll = {m_response_pipe[0], POLLIN, 0};
+
+            int ready = poll(&response_poll, 1, m_response_timeout_ms);
+            if(ready == 0){
+                log_error_message("No response within %u ms!", m_response_timeout_ms);
+                m_timed_out = true;
+                return false;
+            }else if(ready == -1){
+                log_error_message("Could not wait for the response pipe: %s", strerror(errno));
+                return false;
+            }
+        }
+
         // Waiting for status and data length and write it to the same buffer.
         ssize_t bytes_read = read(m_response_pipe[0], buffer, sizeof(uint32_t)+1); 
         if(bytes_read != sizeof(uint32_t)+1){
@@ -178,19 +214,10 @@ namespace testing{
         // Extract status and data length.
         res->response_status = (testing::status)buffer[0];
 
-        // Error checking of the response status.
-        if(res->response_status == STATUS_ERROR){
-            log_error_message("The status of the request indicated an error!");
-            return false;
-        }else if(res->response_status == STATUS_MALFORMED){
-            log_error_message("The the request was malformed!");
-            return false;
-        }
-
-        res->data_length = testing_communication::bytes_to_int32(buffer, 1);
+        res->data_length = load_uint32(buffer + 1, BYTE_ORDER_BIG_ENDIAN);
 
         // Receive data if data is expected.
-        if(res->data_length > 1){
+        if(res->data_length > 0){
             // Allocating memory for data according to the length.
             res->data = (char*)malloc(res->data_length);
 
@@ -229,11 +256,35 @@ namespace testing{
             }
         }
 
+        // Error checking of the response status. The data of an error response is read before, so the next response is not mixed up with it.
+        if(res->response_status == STATUS_ERROR){
+            log_error_message("The status of the request indicated an error!");
+            return false;
+        }else if(res->response_status == STATUS_MALFORMED){
+            log_error_message("The the request was malformed!");
+            return false;
+        }
+
         log_info_message("RECEIVED: %d with length %d.", res->response_status, res->data_length);
 
         return true;
     }
 
+    void pipe_testing_client::close_receiver_end(){
+        int* receiver_fds[] = {&m_request_pipe[0], &m_response_pipe[1], &m_request_fd, &m_response_fd};
+
+        for(int* fd: receiver_fds){
+            if(*fd != -1){
+                close(*fd);
+                *fd = -1;
+            }
+        }
+
+        // VPs forked later must not hold the client ends of this VP.
+        fcntl(m_request_pipe[1], F_SETFD, FD_CLOEXEC);
+        fcntl(m_response_pipe[0], F_SETFD, FD_CLOEXEC);
+    }
+
     int pipe_testing_client::get_request_fd(){
         if(m_specific_fds){
             return m_request_fd;
@@ -64,7 +64,7 @@ namespace testing{
 
         // Copy status and data length into one buffer.
         buffer[0] = res.response_status;
-        testing_communication::int32_to_bytes(res.data_length, buffer, 1);
+        store_uint32(res.data_length, buffer + 1, BYTE_ORDER_BIG_ENDIAN);
 
         // Write the response status.
         ssize_t written = write(m_fd_response, buffer, sizeof(uint32_t)+1);
@@ -117,7 +117,7 @@ namespace testing{
 
         // Extract command and data length.
         m_current_req.request_command = (testing::command)buffer[0];
-        m_current_req.data_length = testing_communication::bytes_to_int32(buffer, 1);
+        m_current_req.data_length = load_uint32(buffer + 1, BYTE_ORDER_BIG_ENDIAN);
 
         // Clearing old data if exist.
         if(m_current_req.data != nullptr){
@@ -126,7 +126,7 @@ namespace testing{
         }
 
         // Receive data if data is expected.
-        if(m_current_req.data_length > 1){
+        if(m_current_req.data_length > 0){
             // Allocating memory for data according to the length.
             m_current_req.data = (char*)malloc(m_current_req.data_length);
 
@@ -0,0 +1,149 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "request_trace.h"
+#include "byte_order.h"
+
+#include <chrono>
+
+namespace testing{
+
+    // Current time on the monotonic clock in nanoseconds.
+    static uint64_t monotonic_time(){
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    request_trace_writer::~request_trace_writer(){
+        close();
+    }
+
+    bool request_trace_writer::open(const std::string &path, bool response_data){
+        close();
+
+        m_file = fopen(path.c_str(), "wb");
+        if(m_file == nullptr) return false;
+
+        // Records are collected in a large buffer, so recording does not cost a write per request.
+        setvbuf(m_file, nullptr, _IOFBF, REQUEST_TRACE_BUFFER_SIZE);
+
+        if(fwrite(REQUEST_TRACE_MAGIC, 1, 8, m_file) != 8){
+            close();
+            return false;
+        }
+
+        m_response_data = response_data;
+        m_start_time = monotonic_time();
+        m_flush_time = m_start_time;
+        m_buffered = 0;
+
+        return true;
+    }
+
+    void request_trace_writer::close(){
+        if(m_file == nullptr) return;
+
+        fclose(m_file);
+        m_file = nullptr;
+    }
+
+    void request_trace_writer::write_request(const request &req){
+        write_record(TRACE_REQUEST, (uint8_t)req.request_command, req.data, req.data_length, req.data_length);
+    }
+
+    void request_trace_writer::write_response(const response &res){
+        uint64_t now = write_record(TRACE_RESPONSE, (uint8_t)res.response_status, res.data, res.data_length, m_response_data ? res.data_length : 0);
+
+        // Between a response and the next request the VP is idle, so this is the cheapest point to write.
+        if(m_buffered >= REQUEST_TRACE_FLUSH_THRESHOLD || now - m_flush_time >= REQUEST_TRACE_FLUSH_INTERVAL_NS) flush();
+    }
+
+    void request_trace_writer::flush(){
+        if(m_file == nullptr) return;
+
+        fflush(m_file);
+        m_buffered = 0;
+        m_flush_time = monotonic_time();
+    }
+
+    uint64_t request_trace_writer::write_record(request_trace_record_type type, uint8_t code, const char* data, uint32_t data_length, uint32_t stored_length){
+        if(m_file == nullptr) return 0;
+
+        if(data == nullptr) stored_length = 0;
+
+        char header[REQUEST_TRACE_RECORD_HEADER_SIZE];
+        header[0] = (char)type;
+        header[1] = (char)code;
+        uint64_t now = monotonic_time();
+
+        // The trace format is big endian, independent of the negotiated byte order.
+        store_uint64(now - m_start_time, header + 2, BYTE_ORDER_BIG_ENDIAN);
+        store_uint32(data_length, header + 10, BYTE_ORDER_BIG_ENDIAN);
+        store_uint32(stored_length, header + 14, BYTE_ORDER_BIG_ENDIAN);
+
+        fwrite(header, 1, sizeof(header), m_file);
+        if(stored_length != 0) fwrite(data, 1, stored_length, m_file);
+
+        m_buffered += sizeof(header) + stored_length;
+
+        return now;
+    }
+
+    request_trace_reader::~request_trace_reader(){
+        close();
+    }
+
+    bool request_trace_reader::open(const std::string &path){
+        close();
+
+        m_file = fopen(path.c_str(), "rb");
+        if(m_file == nullptr) return false;
+
+        char magic[8];
+        if(fread(magic, 1, 8, m_file) != 8 || memcmp(magic, REQUEST_TRACE_MAGIC, 8) != 0){
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void request_trace_reader::close(){
+        if(m_file == nullptr) return;
+
+        fclose(m_file);
+        m_file = nullptr;
+    }
+
+    bool request_trace_reader::next(request_trace_record &record){
+        if(m_file == nullptr) return false;
+
+        char header[REQUEST_TRACE_RECORD_HEADER_SIZE];
+        if(fread(header, 1, sizeof(header), m_file) != sizeof(header)) return false;
+
+        record.type = (request_trace_record_type)header[0];
+        record.code = (uint8_t)header[1];
+        record.timestamp = load_uint64(header + 2, BYTE_ORDER_BIG_ENDIAN);
+        record.data_length = load_uint32(header + 10, BYTE_ORDER_BIG_ENDIAN);
+
+        uint32_t stored_length = load_uint32(header + 14, BYTE_ORDER_BIG_ENDIAN);
+        record.data.resize(stored_length);
+
+        return stored_length == 0 || fread(record.data.data(), 1, stored_length, m_file) == stored_length;
+    }
+}
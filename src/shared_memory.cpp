@@ -0,0 +1,162 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "shared_memory.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace testing{
+
+    sysv_shm_segment::~sysv_shm_segment(){
+        detach();
+    }
+
+    bool sysv_shm_segment::attach(int shm_id, bool read_only){
+        detach();
+
+        char* data = static_cast<char*>(shmat(shm_id, nullptr, read_only ? SHM_RDONLY : 0));
+        if(data == reinterpret_cast<char*>(-1)){
+            return false;
+        }
+
+        struct shmid_ds shm_info;
+        if(shmctl(shm_id, IPC_STAT, &shm_info) == -1){
+            shmdt(data);
+            return false;
+        }
+
+        m_data = data;
+        m_size = shm_info.shm_segsz;
+
+        return true;
+    }
+
+    bool sysv_shm_segment::detach(){
+        if(m_data == nullptr) return true;
+
+        bool success = shmdt(m_data) == 0;
+        m_data = nullptr;
+        m_size = 0;
+
+        return success;
+    }
+
+    bool sysv_shm_segment::contains(size_t offset, size_t length) const {
+        return m_data != nullptr && offset <= m_size && length <= m_size - offset;
+    }
+
+    char* sysv_shm_segment::data() const {
+        return m_data;
+    }
+
+    size_t sysv_shm_segment::size() const {
+        return m_size;
+    }
+
+    posix_shm_region::~posix_shm_region(){
+        close();
+    }
+
+    bool posix_shm_region::open(const std::string &name, bool read_only){
+        close();
+
+        int flags = read_only ? O_RDONLY : O_RDWR;
+        bool is_path = name.size() > 1 && name[0] == '/' && name.find('/', 1) != std::string::npos;
+
+        int fd = is_path ? ::open(name.c_str(), flags) : shm_open(name.c_str(), flags, 0);
+        if(fd == -1) return false;
+
+        struct stat file_info;
+        if(fstat(fd, &file_info) == -1 || file_info.st_size == 0){
+            ::close(fd);
+            return false;
+        }
+
+        // The mapping stays valid after closing the file descriptor.
+        void* data = mmap(nullptr, file_info.st_size, read_only ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(data == MAP_FAILED) return false;
+
+        m_name = name;
+        m_data = static_cast<char*>(data);
+        m_size = file_info.st_size;
+
+        return true;
+    }
+
+    void posix_shm_region::close(){
+        if(m_data == nullptr) return;
+
+        munmap(m_data, m_size);
+        m_name.clear();
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    bool posix_shm_region::contains(size_t offset, size_t length) const {
+        return m_data != nullptr && offset <= m_size && length <= m_size - offset;
+    }
+
+    const std::string& posix_shm_region::name() const {
+        return m_name;
+    }
+
+    char* posix_shm_region::data() const {
+        return m_data;
+    }
+
+    size_t posix_shm_region::size() const {
+        return m_size;
+    }
+
+    anonymous_shared_memory::~anonymous_shared_memory(){
+        release();
+    }
+
+    bool anonymous_shared_memory::allocate(size_t size){
+        release();
+
+        void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if(data == MAP_FAILED) return false;
+
+        m_data = static_cast<char*>(data);
+        m_size = size;
+
+        return true;
+    }
+
+    void anonymous_shared_memory::release(){
+        if(m_data == nullptr) return;
+
+        munmap(m_data, m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    char* anonymous_shared_memory::data() const {
+        return m_data;
+    }
+
+    size_t anonymous_shared_memory::size() const {
+        return m_size;
+    }
+}
@@ -0,0 +1,65 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "testing_client.h"
+
+#include <algorithm>
+
+namespace testing{
+
+    bool testing_client::negotiate(){
+
+        // Without HELLO only the basic commands are used.
+        m_protocol = protocol_info();
+        m_protocol.max_message_size = get_max_message_size();
+
+        // HELLO is always big endian, the byte order of the following requests depends on CAPABILITY_NATIVE_BYTE_ORDER.
+        char data[8];
+        store_uint32(PROTOCOL_VERSION, data, BYTE_ORDER_BIG_ENDIAN);
+        store_uint32(m_requested_capabilities, data + 4, BYTE_ORDER_BIG_ENDIAN);
+
+        request req;
+        req.request_command = HELLO;
+        req.data = data;
+        req.data_length = sizeof(data);
+
+        response res;
+        if(!send_request(&req, &res)){
+            log_error_message("Could not negotiate the protocol!");
+            if(res.data != nullptr) free(res.data);
+            return false;
+        }
+
+        // A VP without HELLO ignores the unknown command and responds without data.
+        if(res.data_length < 16){
+            log_info_message("The VP does not support HELLO, using protocol version 0.");
+        }else{
+            m_protocol.version = load_uint32(res.data, BYTE_ORDER_BIG_ENDIAN);
+            m_protocol.capabilities = load_uint32(res.data + 4, BYTE_ORDER_BIG_ENDIAN) & m_requested_capabilities;
+            m_protocol.max_message_size = std::min<uint32_t>(load_uint32(res.data + 8, BYTE_ORDER_BIG_ENDIAN), m_protocol.max_message_size);
+            m_protocol.coverage_map_size = load_uint32(res.data + 12, BYTE_ORDER_BIG_ENDIAN);
+
+            log_info_message("Negotiated protocol version %u with capabilities 0x%x.", m_protocol.version, m_protocol.capabilities);
+        }
+
+        if(res.data != nullptr) free(res.data);
+
+        return true;
+    }
+}
@@ -0,0 +1,506 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "testing_client_pool.h"
+#include "coverage_map.h"
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <chrono>
+
+namespace testing{
+
+    // Number of attempts to start a VP again after it crashed or hung.
+    static constexpr int RESTART_ATTEMPTS = 3;
+
+    // Time a VP has to exit after the communication failed, before it is considered alive.
+    static constexpr int EXIT_WAIT_MS = 100;
+
+    testing_client_pool::testing_client_pool(const testing_client_pool_config &config): m_config(config){
+    }
+
+    testing_client_pool::~testing_client_pool(){
+        stop();
+    }
+
+    bool testing_client_pool::start(){
+        if(!m_workers.empty()){
+            log_error_message("The pool is already started!");
+            return false;
+        }
+
+        if(m_config.worker_count == 0 || !m_config.create_client || !m_config.spawn_vp){
+            log_error_message("The pool needs at least one worker and the create_client and spawn_vp callbacks!");
+            return false;
+        }
+
+        // Writing to the pipe of a crashed VP must fail with EPIPE instead of terminating the process.
+        signal(SIGPIPE, SIG_IGN);
+
+        if(!m_config.global_coverage.empty() && !create_global_coverage()) return false;
+
+        m_stop = false;
+        m_started_workers = 0;
+        m_running_workers = 0;
+
+        for(size_t i = 0; i < m_config.worker_count; i++){
+            m_workers.push_back(std::unique_ptr<worker>(new worker()));
+            m_workers.back()->index = i;
+        }
+
+        // The workers start their VPs in parallel, only the spawning itself is serialized.
+        for(auto &current: m_workers){
+            current->thread = std::thread(&testing_client_pool::worker_loop, this, std::ref(*current));
+        }
+
+        size_t running_workers;
+        {
+            std::unique_lock<std::mutex> lock(m_idle_mutex);
+            m_idle_condition.wait(lock, [this]{ return m_started_workers == m_workers.size(); });
+            running_workers = m_running_workers;
+        }
+
+        if(running_workers != m_workers.size()){
+            log_error_message("Only %zu of %zu VPs could be started!", running_workers, m_workers.size());
+            stop();
+            return false;
+        }
+
+        log_info_message("Started pool with %zu VPs.", m_workers.size());
+
+        return true;
+    }
+
+    void testing_client_pool::stop(){
+        if(m_workers.empty()){
+            remove_global_coverage();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_work_mutex);
+            m_stop = true;
+        }
+        m_work_condition.notify_all();
+
+        for(auto &current: m_workers){
+            if(current->thread.joinable()) current->thread.join();
+            kill_worker(*current);
+        }
+
+        m_workers.clear();
+        m_queued = 0;
+
+        remove_global_coverage();
+
+        {
+            std::lock_guard<std::mutex> lock(m_idle_mutex);
+            m_pending = 0;
+            m_running_workers = 0;
+        }
+        m_idle_condition.notify_all();
+    }
+
+    void testing_client_pool::submit(pool_test_case test_case){
+        if(m_workers.empty()){
+            log_error_message("The pool is not started!");
+            return;
+        }
+
+        worker &target = *m_workers[m_next_worker++ % m_workers.size()];
+
+        m_pending++;
+        {
+            std::lock_guard<std::mutex> lock(target.queue_mutex);
+            target.queue.push_back(std::move(test_case));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_work_mutex);
+            m_queued++;
+        }
+        m_work_condition.notify_one();
+    }
+
+    void testing_client_pool::submit(std::vector<pool_test_case> &test_cases){
+        if(m_workers.empty()){
+            log_error_message("The pool is not started!");
+            return;
+        }
+
+        size_t worker_count = m_workers.size();
+        size_t first_worker = m_next_worker.fetch_add(test_cases.size());
+
+        m_pending += test_cases.size();
+
+        // Each worker deque is locked once.
+        for(size_t i = 0; i < worker_count && i < test_cases.size(); i++){
+            worker &target = *m_workers[(first_worker + i) % worker_count];
+
+            std::lock_guard<std::mutex> lock(target.queue_mutex);
+            for(size_t j = i; j < test_cases.size(); j += worker_count){
+                target.queue.push_back(std::move(test_cases[j]));
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_work_mutex);
+            m_queued += test_cases.size();
+        }
+        m_work_condition.notify_all();
+
+        test_cases.clear();
+    }
+
+    bool testing_client_pool::wait_idle(){
+        std::unique_lock<std::mutex> lock(m_idle_mutex);
+        m_idle_condition.wait(lock, [this]{ return m_pending == 0 || m_running_workers == 0; });
+
+        return m_pending == 0;
+    }
+
+    void testing_client_pool::set_result_callback(std::function<void(const pool_test_result&)> callback){
+        std::lock_guard<std::mutex> lock(m_result_mutex);
+        m_result_callback = callback;
+    }
+
+    pool_statistics testing_client_pool::get_statistics() const {
+        pool_statistics statistics;
+        statistics.executed = m_executed;
+        statistics.errors = m_errors;
+        statistics.crashes = m_crashes;
+        statistics.hangs = m_hangs;
+        statistics.restarts = m_restarts;
+
+        return statistics;
+    }
+
+    size_t testing_client_pool::get_worker_count() const {
+        return m_config.worker_count;
+    }
+
+    const uint8_t* testing_client_pool::get_global_coverage() const {
+        return m_global_coverage;
+    }
+
+    bool testing_client_pool::create_global_coverage(){
+        if(m_config.global_coverage.size() > 255){
+            log_error_message("The name of the global coverage is too long!");
+            return false;
+        }
+
+        // A leftover object of a previous pool would contain its coverage.
+        shm_unlink(m_config.global_coverage.c_str());
+
+        int fd = shm_open(m_config.global_coverage.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if(fd == -1){
+            log_error_message("Could not create the global coverage %s: %s", m_config.global_coverage.c_str(), strerror(errno));
+            return false;
+        }
+
+        void* data = MAP_FAILED;
+        if(ftruncate(fd, MAP_SIZE) == 0) data = mmap(nullptr, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if(data == MAP_FAILED){
+            log_error_message("Could not map the global coverage %s: %s", m_config.global_coverage.c_str(), strerror(errno));
+            shm_unlink(m_config.global_coverage.c_str());
+            return false;
+        }
+
+        m_global_coverage = static_cast<uint8_t*>(data);
+
+        return true;
+    }
+
+    void testing_client_pool::remove_global_coverage(){
+        if(m_global_coverage == nullptr) return;
+
+        munmap(m_global_coverage, MAP_SIZE);
+        shm_unlink(m_config.global_coverage.c_str());
+        m_global_coverage = nullptr;
+    }
+
+    void testing_client_pool::worker_loop(worker &current){
+        bool started = spawn_worker(current);
+
+        {
+            std::lock_guard<std::mutex> lock(m_idle_mutex);
+            m_started_workers++;
+            if(started) m_running_workers++;
+        }
+        m_idle_condition.notify_all();
+
+        if(!started) return;
+
+        pool_test_case test_case;
+        while(!m_stop){
+            if(!next_test_case(current, test_case)){
+                std::unique_lock<std::mutex> lock(m_work_mutex);
+                m_work_condition.wait(lock, [this]{ return m_queued > 0 || m_stop; });
+                continue;
+            }
+
+            execute(current, test_case);
+
+            // The VP could not be started again, the remaining test cases of this worker are stolen by the others.
+            if(current.client == nullptr && !m_stop){
+                log_error_message("Worker %zu stopped, because its VP could not be restarted.", current.index);
+
+                {
+                    std::lock_guard<std::mutex> lock(m_idle_mutex);
+                    m_running_workers--;
+                }
+                m_idle_condition.notify_all();
+                m_work_condition.notify_all();
+
+                return;
+            }
+        }
+    }
+
+    bool testing_client_pool::next_test_case(worker &current, pool_test_case &test_case){
+        {
+            std::lock_guard<std::mutex> lock(current.queue_mutex);
+            if(!current.queue.empty()){
+                test_case = std::move(current.queue.front());
+                current.queue.pop_front();
+                m_queued--;
+                return true;
+            }
+        }
+
+        // Steal half of the deque of the next worker that has test cases, starting at the neighbour to spread the stealing.
+        size_t worker_count = m_workers.size();
+        for(size_t i = 1; i < worker_count; i++){
+            worker &victim = *m_workers[(current.index + i) % worker_count];
+
+            std::deque<pool_test_case> stolen;
+            {
+                std::lock_guard<std::mutex> lock(victim.queue_mutex);
+                size_t count = (victim.queue.size() + 1) / 2;
+                if(count == 0) continue;
+
+                auto first = victim.queue.end() - count;
+                stolen.insert(stolen.end(), std::make_move_iterator(first), std::make_move_iterator(victim.queue.end()));
+                victim.queue.erase(first, victim.queue.end());
+            }
+
+            test_case = std::move(stolen.front());
+            stolen.pop_front();
+            m_queued--;
+
+            if(!stolen.empty()){
+                std::lock_guard<std::mutex> lock(current.queue_mutex);
+                current.queue.insert(current.queue.end(), std::make_move_iterator(stolen.begin()), std::make_move_iterator(stolen.end()));
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void testing_client_pool::execute(worker &current, pool_test_case &test_case){
+        request req;
+        req.request_command = test_case.request_command;
+        req.data = test_case.data.empty() ? nullptr : test_case.data.data();
+        req.data_length = test_case.data.size();
+
+        // The status stays STATUS_OK if no response was received.
+        response res;
+        res.response_status = STATUS_OK;
+
+        pool_test_result result;
+        result.id = test_case.id;
+        result.worker = current.index;
+
+        bool restart = false;
+
+        if(current.client->send_request(&req, &res)){
+            result.outcome = POOL_RUN_OK;
+            result.response_status = res.response_status;
+            if(res.data != nullptr) result.data.assign(res.data, res.data + res.data_length);
+
+        }else if(res.response_status != STATUS_OK){
+            // The VP responded with an error and can be used further.
+            result.outcome = POOL_RUN_ERROR;
+            result.response_status = res.response_status;
+
+        }else{
+            restart = true;
+            result.response_status = STATUS_ERROR;
+
+            if(current.client->has_timed_out()){
+                result.outcome = POOL_RUN_HUNG;
+            }else{
+                // A crashed VP closed the communication, it is a zombie shortly after.
+                result.outcome = POOL_RUN_ERROR;
+                for(int i = 0; i < EXIT_WAIT_MS; i++){
+                    if(waitpid(current.pid, &result.exit_status, WNOHANG) == current.pid){
+                        result.outcome = POOL_RUN_CRASHED;
+                        current.pid = -1;
+                        break;
+                    }
+
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        }
+
+        if(res.data != nullptr) free(res.data);
+
+        deliver(result);
+
+        if(!restart) return;
+
+        kill_worker(current);
+        if(m_stop) return;
+
+        for(int attempt = 0; attempt < RESTART_ATTEMPTS; attempt++){
+            m_restarts++;
+            if(spawn_worker(current)) return;
+        }
+    }
+
+    bool testing_client_pool::spawn_worker(worker &current){
+        testing_client* client;
+
+        {
+            std::lock_guard<std::mutex> lock(m_spawn_mutex);
+
+            client = m_config.create_client(current.index);
+            if(client == nullptr){
+                log_error_message("Could not create the client of worker %zu!", current.index);
+                return false;
+            }
+
+            current.client.reset(client);
+            client->log_info_message = log_info_message;
+            client->log_error_message = log_error_message;
+
+            if(!client->start()){
+                log_error_message("Could not start the client of worker %zu!", current.index);
+                current.client.reset();
+                return false;
+            }
+
+            current.pid = m_config.spawn_vp(current.index, client);
+            if(current.pid < 0){
+                log_error_message("Could not spawn the VP of worker %zu!", current.index);
+                current.client.reset();
+                return false;
+            }
+
+            client->close_receiver_end();
+        }
+
+        client->set_response_timeout(m_config.run_timeout_ms);
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_config.ready_timeout_ms);
+        while(!client->check_for_ready()){
+            if(waitpid(current.pid, nullptr, WNOHANG) == current.pid){
+                log_error_message("The VP of worker %zu exited before it was ready!", current.index);
+                current.pid = -1;
+                kill_worker(current);
+                return false;
+            }
+
+            if(std::chrono::steady_clock::now() > deadline){
+                log_error_message("The VP of worker %zu was not ready within %u ms!", current.index, m_config.ready_timeout_ms);
+                kill_worker(current);
+                return false;
+            }
+
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+
+        // A VP that negotiated the protocol but does not support the global coverage would ignore it (VPs without HELLO are tried anyway).
+        if(m_global_coverage != nullptr && client->get_protocol().version > 0 && !client->supports(CAPABILITY_GLOBAL_COVERAGE)){
+            log_error_message("The VP of worker %zu does not support the global coverage!", current.index);
+            kill_worker(current);
+            return false;
+        }
+
+        if(m_global_coverage != nullptr){
+            request req;
+            response res;
+
+            // Content: Name length + name.
+            std::vector<char> data(1 + m_config.global_coverage.size());
+            data[0] = (char)m_config.global_coverage.size();
+            memcpy(data.data() + 1, m_config.global_coverage.data(), m_config.global_coverage.size());
+
+            req.request_command = ATTACH_GLOBAL_COVERAGE;
+            req.data = data.data();
+            req.data_length = data.size();
+
+            bool attached = client->send_request(&req, &res);
+            free(res.data);
+
+            if(!attached){
+                log_error_message("The VP of worker %zu could not attach the global coverage!", current.index);
+                kill_worker(current);
+                return false;
+            }
+        }
+
+        if(m_config.setup && !m_config.setup(current.index, client)){
+            log_error_message("The setup of the VP of worker %zu failed!", current.index);
+            kill_worker(current);
+            return false;
+        }
+
+        log_info_message("VP of worker %zu is ready (pid %d).", current.index, current.pid);
+
+        return true;
+    }
+
+    void testing_client_pool::kill_worker(worker &current){
+        if(current.pid > 0){
+            kill(current.pid, SIGKILL);
+            waitpid(current.pid, nullptr, 0);
+            current.pid = -1;
+        }
+
+        current.client.reset();
+    }
+
+    void testing_client_pool::deliver(pool_test_result &result){
+        m_executed++;
+        if(result.outcome == POOL_RUN_ERROR) m_errors++;
+        else if(result.outcome == POOL_RUN_CRASHED) m_crashes++;
+        else if(result.outcome == POOL_RUN_HUNG) m_hangs++;
+
+        {
+            std::lock_guard<std::mutex> lock(m_result_mutex);
+            if(m_result_callback) m_result_callback(result);
+        }
+
+        bool idle;
+        {
+            std::lock_guard<std::mutex> lock(m_idle_mutex);
+            idle = --m_pending == 0;
+        }
+        if(idle) m_idle_condition.notify_all();
+    }
+}
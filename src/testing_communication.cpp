@@ -19,53 +19,39 @@
 
 #include "testing_communication.h"
 
+#include <cstdlib>
+
 namespace testing{
 
-    bool testing_communication::is_started(){
-        return m_started;
+    testing_communication::testing_communication(testing_receiver* receiver):m_testing_receiver(receiver){
+        const char* record_path = getenv("VPTI_RECORD");
+        if(record_path != nullptr && record_path[0] != '\0') start_recording(record_path);
     }
 
-    void testing_communication::respond_malformed(response &res){
-        res.response_status = STATUS_MALFORMED;
-        res.data = nullptr;
-        res.data_length = 0;
+    bool testing_communication::start_recording(const std::string &path, bool response_data){
+        return m_recorder.open(path, response_data);
     }
 
-    void testing_communication::int32_to_bytes(int32_t value, char* buffer, size_t start){
-        buffer[start]     = (char)((value >> 24) & 0xFF);
-        buffer[start + 1] = (char)((value >> 16) & 0xFF);
-        buffer[start + 2] = (char)((value >> 8) & 0xFF);
-        buffer[start + 3] = (char)(value & 0xFF);    
+    void testing_communication::stop_recording(){
+        m_recorder.close();
     }
 
-    int32_t testing_communication::bytes_to_int32(const char* buffer, size_t start){
-        return  ((int32_t)(uint8_t)buffer[start] << 24) |
-                ((int32_t)(uint8_t)buffer[start + 1] << 16) |
-                ((int32_t)(uint8_t)buffer[start + 2] << 8)  |
-                ((int32_t)(uint8_t)buffer[start + 3]);
+    bool testing_communication::is_started(){
+        return m_started;
+    }
+
+    uint32_t testing_communication::get_max_message_size(){
+        return std::numeric_limits<uint32_t>::max();
     }
 
-    void testing_communication::int64_to_bytes(int64_t value, char* buffer, size_t start) {
-        buffer[start]     = (char)((value >> 56) & 0xFF); // MSB
-        buffer[start + 1] = (char)((value >> 48) & 0xFF);
-        buffer[start + 2] = (char)((value >> 40) & 0xFF);
-        buffer[start + 3] = (char)((value >> 32) & 0xFF);
-        buffer[start + 4] = (char)((value >> 24) & 0xFF);
-        buffer[start + 5] = (char)((value >> 16) & 0xFF);
-        buffer[start + 6] = (char)((value >> 8)  & 0xFF);
-        buffer[start + 7] = (char)(value & 0xFF);         // LSB
+    void testing_communication::respond_malformed(response &res){
+        res.response_status = STATUS_MALFORMED;
+        res.data = nullptr;
+        res.data_length = 0;
     }
 
-    // Convert 8-byte big-endian buffer to int64_t from a specific index
-    int64_t testing_communication::bytes_to_int64(const char* buffer, size_t start) {
-        return ((int64_t)(uint8_t)buffer[start] << 56) |
-            ((int64_t)(uint8_t)buffer[start + 1] << 48) |
-            ((int64_t)(uint8_t)buffer[start + 2] << 40) |
-            ((int64_t)(uint8_t)buffer[start + 3] << 32) |
-            ((int64_t)(uint8_t)buffer[start + 4] << 24) |
-            ((int64_t)(uint8_t)buffer[start + 5] << 16) |
-            ((int64_t)(uint8_t)buffer[start + 6] << 8)  |
-            ((int64_t)(uint8_t)buffer[start + 7]);
+    void testing_communication::set_byte_order(byte_order order){
+        m_byte_order.store(order, std::memory_order_relaxed);
     }
 
     bool testing_communication::check_cast_to_uint32(uint64_t value) {
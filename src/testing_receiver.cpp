@@ -19,6 +19,12 @@
 
 #include "testing_receiver.h"
 
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <chrono>
+
 namespace testing{
 
     testing_receiver::testing_receiver(){
@@ -30,6 +36,10 @@ namespace testing{
         // m_full_slots signals new events in event queue.
         sem_init(&m_empty_slots, 0, 0); 
         sem_init(&m_full_slots, 0, 0);
+
+        // One coverage shard by default.
+        m_coverage_shards.push_back(create_coverage_shard());
+        m_primary_tracker = &m_coverage_shards[0]->tracker;
     }
 
     testing_receiver::~testing_receiver(){
@@ -61,14 +71,78 @@ namespace testing{
     bool testing_receiver::start_receiver_in_thread(){
         log_info_message("Receiver thread starting.");
 
+        // The simulation runs in another thread than the receiver loop, which rules out FORK_SERVER.
+        m_receiver_in_thread = true;
+
         // Starts the receiver loop inside a new thread.
         m_receiver_thread = std::thread([this] {
+            if(!apply_thread_placement(m_receiver_placement)){
+                log_error_message("Could not apply the placement of the receiver thread: %s", strerror(errno));
+            }
+
             this->receiver_loop();
         });
 
         return true;
     }
 
+    void testing_receiver::set_receiver_thread_placement(const thread_placement &placement){
+        m_receiver_placement = placement;
+    }
+
+    void testing_receiver::set_simulation_thread_placement(const thread_placement &placement){
+        m_simulation_placement = placement;
+    }
+
+    bool testing_receiver::place_simulation_thread(){
+        if(!apply_thread_placement(m_simulation_placement)){
+            log_error_message("Could not apply the placement of the simulation thread: %s", strerror(errno));
+            return false;
+        }
+
+        return true;
+    }
+
+    bool testing_receiver::set_memory_placement(int numa_node, bool huge_pages){
+        if(numa_node < 0 && !m_simulation_placement.cpus.empty()){
+            numa_node = numa_node_of_cpu(m_simulation_placement.cpus[0]);
+        }
+
+        m_memory_node = numa_node;
+        m_huge_pages = huge_pages;
+
+        // Existing buffers are moved.
+        bool placed = true;
+        for(auto &shard: m_coverage_shards){
+            placed &= place_memory(shard.get(), sizeof(coverage_shard), m_memory_node, m_huge_pages);
+        }
+
+        placed &= place_memory(m_seen_coverage.data(), m_seen_coverage.size(), m_memory_node, m_huge_pages);
+        placed &= place_memory(m_input_region.data(), m_input_region.size(), m_memory_node, m_huge_pages);
+
+        if(!placed){
+            log_error_message("Could not place the shared buffers on NUMA node %d: %s", m_memory_node, strerror(errno));
+            return false;
+        }
+
+        return true;
+    }
+
+    void testing_receiver::place_buffer(void* start, size_t size){
+        if(m_memory_node < 0 && !m_huge_pages) return;
+
+        if(!place_memory(start, size, m_memory_node, m_huge_pages)){
+            log_error_message("Could not place a buffer on NUMA node %d: %s", m_memory_node, strerror(errno));
+        }
+    }
+
+    bool testing_receiver::allocate_seen_coverage(){
+        if(!m_seen_coverage.allocate(MAP_SIZE)) return false;
+
+        place_buffer(m_seen_coverage.data(), m_seen_coverage.size());
+        return true;
+    }
+
     status testing_receiver::handle_do_run_shm(std::string start_breakpoint, std::string end_breakpoint, uint64_t mmio_address, size_t mmio_length, int shm_id, unsigned int offset, bool stop_after_string_termination, std::string &register_name)
     {
         log_info_message("Loading MMIO data from shared memory %d.", shm_id);
@@ -106,6 +180,53 @@ namespace testing{
         return return_status;
     }
 
+    status testing_receiver::handle_do_run_posix_shm(std::string &start_breakpoint, std::string &end_breakpoint, uint64_t mmio_address, size_t mmio_length, std::string &region_name, std::string &register_name)
+    {
+        // The region is only mapped again if the name changes or the input does not fit (the client may have grown it).
+        if(m_input_region.name() != region_name){
+            m_input_sequence = UINT64_MAX;
+
+            if(!m_input_region.open(region_name, true)){
+                log_error_message("Failed to map input region %s: %s", region_name.c_str(), strerror(errno));
+                return STATUS_ERROR;
+            }
+
+            place_buffer(m_input_region.data(), m_input_region.size());
+        }
+
+        if(!m_input_region.contains(0, SHM_INPUT_HEADER_SIZE)){
+            log_error_message("The input region is smaller than its header!");
+            return STATUS_ERROR;
+        }
+
+        const shm_input_header* header = reinterpret_cast<const shm_input_header*>(m_input_region.data());
+        uint64_t sequence = header->sequence.load(std::memory_order_acquire);
+        uint64_t length = header->length;
+
+        if(!m_input_region.contains(SHM_INPUT_HEADER_SIZE, length)){
+            if(!m_input_region.open(region_name, true)){
+                log_error_message("Failed to map input region %s: %s", region_name.c_str(), strerror(errno));
+                return STATUS_ERROR;
+            }
+
+            place_buffer(m_input_region.data(), m_input_region.size());
+
+            if(!m_input_region.contains(SHM_INPUT_HEADER_SIZE, length)){
+                log_error_message("The input length %lu does not fit into the input region!", (unsigned long)length);
+                return STATUS_ERROR;
+            }
+        }
+
+        m_input_reused = sequence == m_input_sequence;
+        m_input_sequence = sequence;
+
+        return handle_do_run(start_breakpoint, end_breakpoint, mmio_address, mmio_length, length, m_input_region.data() + SHM_INPUT_HEADER_SIZE, register_name);
+    }
+
+    bool testing_receiver::is_input_reused() const {
+        return m_input_reused;
+    }
+
     status testing_receiver::handle_get_code_coverage_shm(int shm_id, unsigned int offset)
     {
         //TODO check if coverage was enabled !?
@@ -131,7 +252,7 @@ namespace testing{
         }
 
         // Write the data to the shared memory
-        std::memcpy(shm_addr+offset, m_bb_array, MAP_SIZE*sizeof(uint8_t));
+        copy_coverage_to(reinterpret_cast<uint8_t*>(shm_addr+offset));
 
         // Detach the shared memory
         if (shmdt(shm_addr) == -1) {
@@ -142,6 +263,495 @@ namespace testing{
         return  STATUS_OK;
     }
 
+    status testing_receiver::handle_do_run_batch(std::string &start_breakpoint, std::string &end_breakpoint, uint64_t mmio_address, size_t mmio_length, int input_shm_id, uint32_t case_count, uint32_t table_offset, int result_shm_id, uint32_t result_offset, bool coverage_slots, std::string &register_name, uint32_t &executed_cases)
+    {
+        log_info_message("Running batch of %d test cases from shared memory %d.", case_count, input_shm_id);
+
+        executed_cases = 0;
+
+        // Using shared memory directly for better performance, like DO_RUN_SHM.
+        sysv_shm_segment input;
+        if(!input.attach(input_shm_id, true)){
+            log_error_message("Failed to attach input shared memory segment: %s", strerror(errno));
+            return STATUS_ERROR;
+        }
+
+        sysv_shm_segment results;
+        if(!results.attach(result_shm_id, false)){
+            log_error_message("Failed to attach result shared memory segment: %s", strerror(errno));
+            return STATUS_ERROR;
+        }
+
+        // Each table entry contains offset and length (4 bytes each).
+        if(!input.contains(table_offset, (size_t)case_count * 8)){
+            log_error_message("The test case table does not fit into the input shared memory!");
+            return STATUS_ERROR;
+        }
+
+        size_t results_length = (size_t)case_count * RUN_BATCH_RECORD_SIZE;
+        if(coverage_slots) results_length += (size_t)case_count * MAP_SIZE;
+
+        if(!results.contains(result_offset, results_length)){
+            log_error_message("The results do not fit into the result shared memory!");
+            return STATUS_ERROR;
+        }
+
+        const char* table = input.data() + table_offset;
+        char* records = results.data() + result_offset;
+        uint8_t* slots = reinterpret_cast<uint8_t*>(records + (size_t)case_count * RUN_BATCH_RECORD_SIZE);
+
+        // Converting the whole table at once (offset and length of each test case).
+        std::vector<uint32_t> entries((size_t)case_count * 2);
+        load_uint32_array(table, entries.size(), entries.data(), data_byte_order());
+
+        for(uint32_t i = 0; i < case_count; i++){
+            uint32_t case_offset = entries[(size_t)i * 2];
+            uint32_t case_length = entries[(size_t)i * 2 + 1];
+
+            if(!input.contains(case_offset, case_length)){
+                log_error_message("Test case %d does not fit into the input shared memory!", i);
+                return STATUS_ERROR;
+            }
+
+            char* record = records + (size_t)i * RUN_BATCH_RECORD_SIZE;
+
+            begin_run();
+
+            if(m_fork_server){
+                // The child writes the record and the coverage slot directly to the result memory, which is shared with this process.
+                std::vector<char> output;
+                int wait_status;
+                bool forked = run_in_fork_child([&](std::vector<char>&){
+                    std::string run_start;
+                    status run_status = handle_do_run(run_start, end_breakpoint, mmio_address, mmio_length, case_length, input.data() + case_offset, register_name);
+                    complete_run();
+
+                    write_run_batch_record(record, run_status);
+                    if(coverage_slots) copy_coverage_to(slots + (size_t)i * MAP_SIZE);
+                }, output, wait_status);
+
+                if(!forked) return STATUS_ERROR;
+
+                // A crashed (or killed) child is recorded as VP_ERROR with the coverage up to the crash.
+                if(!WIFEXITED(wait_status) || WEXITSTATUS(wait_status) != 0){
+                    m_run_result.end_event = VP_ERROR;
+                    complete_run_coverage();
+
+                    write_run_batch_record(record, STATUS_ERROR);
+                    if(coverage_slots) copy_coverage_to(slots + (size_t)i * MAP_SIZE);
+                }
+            }else{
+                status run_status = handle_do_run(start_breakpoint, end_breakpoint, mmio_address, mmio_length, case_length, input.data() + case_offset, register_name);
+                complete_run();
+
+                write_run_batch_record(record, run_status);
+                if(coverage_slots) copy_coverage_to(slots + (size_t)i * MAP_SIZE);
+            }
+
+            executed_cases++;
+        }
+
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_persistent_run(std::string &start_breakpoint, std::string &end_breakpoint, uint64_t mmio_address, size_t mmio_length, int input_shm_id, uint32_t input_offset, int result_shm_id, uint32_t result_offset, uint32_t max_runs, bool restore_snapshot, std::string &register_name, uint32_t &executed_cases)
+    {
+        log_info_message("Starting persistent run loop with input ring in shared memory %d.", input_shm_id);
+
+        // The loop would change the state the fork server forks from.
+        if(m_fork_server){
+            log_error_message("PERSISTENT_RUN is not supported in fork server mode!");
+            return STATUS_ERROR;
+        }
+
+        executed_cases = 0;
+
+        // Both rings are written by this side (tail of the input ring, head of the result ring).
+        sysv_shm_segment input_segment;
+        if(!input_segment.attach(input_shm_id, false)){
+            log_error_message("Failed to attach input shared memory segment: %s", strerror(errno));
+            return STATUS_ERROR;
+        }
+
+        sysv_shm_segment result_segment;
+        if(!result_segment.attach(result_shm_id, false)){
+            log_error_message("Failed to attach result shared memory segment: %s", strerror(errno));
+            return STATUS_ERROR;
+        }
+
+        shm_ring input;
+        shm_ring results;
+        if(!input_segment.contains(input_offset, 0) || !input.attach(input_segment.data() + input_offset, input_segment.size() - input_offset)
+            || !result_segment.contains(result_offset, 0) || !results.attach(result_segment.data() + result_offset, result_segment.size() - result_offset)){
+            log_error_message("No valid ring found in the shared memory!");
+            return STATUS_ERROR;
+        }
+
+        if(restore_snapshot && !m_memory_snapshot.has_snapshot()){
+            log_error_message("No snapshot to restore.");
+            return STATUS_ERROR;
+        }
+
+        char record[RUN_BATCH_RECORD_SIZE];
+        uint32_t backoff_round = 0;
+
+        while(max_runs == 0 || executed_cases < max_runs){
+            if(input.is_stop_requested()) break;
+
+            char* case_data;
+            uint32_t case_length;
+            shm_ring_front_result front_result = input.front(case_data, case_length);
+
+            // The record can never be read, so waiting for it would never end.
+            if(front_result == SHM_RING_MALFORMED){
+                log_error_message("Malformed test case record in the input ring after %d test cases!", executed_cases);
+                return STATUS_ERROR;
+            }
+
+            if(front_result == SHM_RING_EMPTY || !results.has_space(RUN_BATCH_RECORD_SIZE)){
+                shm_ring_backoff(backoff_round);
+                continue;
+            }
+            backoff_round = 0;
+
+            if(restore_snapshot){
+                uint32_t restored_pages;
+                if(handle_snapshot_restore(restored_pages) != STATUS_OK) return STATUS_ERROR;
+            }
+
+            begin_run();
+            status run_status = handle_do_run(start_breakpoint, end_breakpoint, mmio_address, mmio_length, case_length, case_data, register_name);
+            complete_run();
+
+            input.pop();
+
+            write_run_batch_record(record, run_status);
+            results.push(record, RUN_BATCH_RECORD_SIZE);
+
+            executed_cases++;
+        }
+
+        log_info_message("Persistent run loop stopped after %d test cases.", executed_cases);
+
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_fork_server(std::string &start_breakpoint, uint32_t timeout_ms){
+        if(m_fork_server){
+            log_error_message("The fork server is already running!");
+            return STATUS_ERROR;
+        }
+
+        // A child only contains the forking thread, so the simulation thread would be missing and every run would wait for events until the timeout.
+        if(m_receiver_in_thread){
+            log_error_message("The fork server is not supported with start_receiver_in_thread, the simulation must run in the thread of the receiver loop!");
+            return STATUS_ERROR;
+        }
+
+        // The seen coverage must exist before the first fork, otherwise every child allocates its own.
+        bool allocated = m_fork_server_state.data() != nullptr || m_fork_server_state.allocate(sizeof(fork_server_state));
+        if(allocated && m_seen_coverage.data() == nullptr) allocated = allocate_seen_coverage();
+
+        if(!allocated){
+            log_error_message("Could not allocate the fork server state: %s", strerror(errno));
+            return STATUS_ERROR;
+        }
+
+        status start_status = handle_fork_server_start(start_breakpoint);
+        if(start_status != STATUS_OK){
+            log_error_message("Could not run to the start breakpoint %s of the fork server!", start_breakpoint.c_str());
+            return start_status;
+        }
+
+        m_fork_server = true;
+        m_fork_server_timeout_ms = timeout_ms;
+
+        log_info_message("Fork server started at %s.", start_breakpoint.c_str());
+
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_fork_server_start(std::string &start_breakpoint){
+        if(start_breakpoint.empty()) return STATUS_OK;
+
+        if(handle_set_breakpoint(start_breakpoint, 0) != STATUS_OK) return STATUS_ERROR;
+
+        event last_event;
+        status continue_status = handle_continue(last_event);
+        if(last_event.addition_data != nullptr) free(last_event.addition_data);
+
+        handle_remove_breakpoint(start_breakpoint);
+
+        if(continue_status != STATUS_OK || last_event.event != BREAKPOINT_HIT) return STATUS_ERROR;
+
+        return STATUS_OK;
+    }
+
+    void testing_receiver::handle_fork_child(){
+    }
+
+    std::string testing_receiver::run_start_breakpoint(const std::string &start_breakpoint) const{
+        return m_fork_server ? std::string() : start_breakpoint;
+    }
+
+    void testing_receiver::execute_single_run(response &res, const std::function<status()> &run){
+        if(!m_fork_server){
+            begin_single_run();
+            res.response_status = run();
+            complete_single_run(res);
+            return;
+        }
+
+        fork_server_state* state = reinterpret_cast<fork_server_state*>(m_fork_server_state.data());
+
+        // The child sends the status and the response data of the run.
+        std::vector<char> output;
+        int wait_status;
+        bool forked = run_in_fork_child([&](std::vector<char> &child_output){
+            begin_single_run();
+            status run_status = run();
+            complete_single_run(res);
+
+            uint64_t return_code;
+            state->return_code_valid = handle_get_return_code(return_code) == STATUS_OK;
+            state->return_code = return_code;
+
+            child_output.push_back((char)run_status);
+            child_output.insert(child_output.end(), res.data, res.data + res.data_length);
+        }, output, wait_status);
+
+        res.data = nullptr;
+        res.data_length = 0;
+
+        if(!forked){
+            res.response_status = STATUS_ERROR;
+            return;
+        }
+
+        std::vector<char> data;
+        if(WIFEXITED(wait_status) && WEXITSTATUS(wait_status) == 0 && !output.empty()){
+            res.response_status = (status)output[0];
+            data.assign(output.begin() + 1, output.end());
+        }else{
+            // The child crashed or was killed after the timeout. This is a result of the run (like a crash of the target), so the status is OK and the wait status tells what happened. The coverage up to the crash is in the shared coverage shards.
+            res.response_status = STATUS_OK;
+            state->return_code_valid = false;
+
+            if(m_run_options & RUN_OPTION_RESULT_RECORD){
+                m_run_result = run_result();
+                m_run_result.end_event = VP_ERROR;
+                complete_run_coverage();
+
+                write_run_result_record(res);
+                data.assign(res.data, res.data + res.data_length);
+                free(res.data);
+            }
+        }
+
+        // Wait status of the child, appended to the data of the run.
+        data.resize(data.size() + sizeof(uint32_t));
+        int32_to_bytes((uint32_t)wait_status, data.data(), data.size() - sizeof(uint32_t));
+
+        res.data_length = data.size();
+        res.data = (char*)malloc(res.data_length);
+        memcpy(res.data, data.data(), res.data_length);
+    }
+
+    bool testing_receiver::run_in_fork_child(const std::function<void(std::vector<char>&)> &work, std::vector<char> &output, int &wait_status){
+        int output_pipe[2];
+        if(pipe(output_pipe) == -1){
+            log_error_message("Could not create the pipe of the fork server child: %s", strerror(errno));
+            return false;
+        }
+
+        // Output of the parent must not be written twice.
+        fflush(nullptr);
+
+        pid_t pid = fork();
+        if(pid == -1){
+            log_error_message("Could not fork the fork server child: %s", strerror(errno));
+            close(output_pipe[0]);
+            close(output_pipe[1]);
+            return false;
+        }
+
+        if(pid == 0){
+            close(output_pipe[0]);
+            handle_fork_child();
+
+            std::vector<char> child_output;
+            work(child_output);
+
+            size_t written = 0;
+            while(written < child_output.size()){
+                ssize_t result = write(output_pipe[1], child_output.data() + written, child_output.size() - written);
+                if(result <= 0) _exit(1);
+                written += result;
+            }
+
+            // The child must not run the destructors of the VP.
+            fflush(nullptr);
+            _exit(0);
+        }
+
+        close(output_pipe[1]);
+
+        output.clear();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_fork_server_timeout_ms);
+
+        // Reads the output until the child closes the pipe (when it exits).
+        char buffer[4096];
+        while(true){
+            if(m_fork_server_timeout_ms > 0){
+                int remaining = (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+
+                struct pollfd output_poll = {output_pipe[0], POLLIN, 0};
+                if(remaining <= 0 || poll(&output_poll, 1, remaining) == 0){
+                    log_error_message("The fork server child %d did not finish within %u ms!", pid, m_fork_server_timeout_ms);
+                    kill(pid, SIGKILL);
+                    break;
+                }
+            }
+
+            ssize_t bytes_read = read(output_pipe[0], buffer, sizeof(buffer));
+            if(bytes_read == -1 && errno == EINTR) continue;
+            if(bytes_read <= 0) break;
+
+            output.insert(output.end(), buffer, buffer + bytes_read);
+        }
+
+        close(output_pipe[0]);
+
+        while(waitpid(pid, &wait_status, 0) == -1){
+            if(errno != EINTR){
+                log_error_message("Could not wait for the fork server child %d: %s", pid, strerror(errno));
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    status testing_receiver::handle_set_run_options(uint8_t options){
+        m_run_options = options;
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_enable_mmio_trace(int shm_id, uint32_t offset, mmio_trace_encoding encoding, mmio_trace_policy policy){
+        handle_disable_mmio_trace();
+
+        if(!m_mmio_trace_segment.attach(shm_id, false)){
+            log_error_message("Failed to attach MMIO trace shared memory segment: %s", strerror(errno));
+            return STATUS_ERROR;
+        }
+
+        if(!m_mmio_trace_segment.contains(offset, 0) || !m_mmio_trace.attach(m_mmio_trace_segment.data() + offset, m_mmio_trace_segment.size() - offset, encoding, policy)){
+            log_error_message("No valid MMIO trace ring found in the shared memory!");
+            m_mmio_trace_segment.detach();
+            return STATUS_ERROR;
+        }
+
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_disable_mmio_trace(){
+        m_mmio_trace.detach();
+        m_mmio_trace_segment.detach();
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_enable_event_push(int shm_id, uint32_t offset, uint32_t wakeup_offset, uint32_t event_mask){
+        handle_disable_event_push();
+
+        if(!m_event_push_segment.attach(shm_id, false)){
+            log_error_message("Failed to attach event push shared memory segment: %s", strerror(errno));
+            return STATUS_ERROR;
+        }
+
+        std::atomic<uint32_t>* wakeup = nullptr;
+        if(wakeup_offset != EVENT_PUSH_NO_WAKEUP){
+            if(wakeup_offset % sizeof(uint32_t) != 0 || !m_event_push_segment.contains(wakeup_offset, sizeof(uint32_t))){
+                log_error_message("The wakeup word of the event push is not aligned or outside the shared memory!");
+                m_event_push_segment.detach();
+                return STATUS_ERROR;
+            }
+
+            wakeup = reinterpret_cast<std::atomic<uint32_t>*>(m_event_push_segment.data() + wakeup_offset);
+        }
+
+        if(!m_event_push_segment.contains(offset, 0) || !m_event_push.attach(m_event_push_segment.data() + offset, m_event_push_segment.size() - offset, event_mask, wakeup)){
+            log_error_message("No valid event ring found in the shared memory!");
+            m_event_push_segment.detach();
+            return STATUS_ERROR;
+        }
+
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_disable_event_push(){
+        // detach waits for a push of the simulation thread in progress, only then the segment is unmapped.
+        m_event_push.detach();
+        m_event_push_segment.detach();
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_get_simulation_time(uint64_t &time){
+        time = 0;
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_get_capabilities(uint32_t &capabilities){
+        capabilities = CAPABILITIES_LIBRARY;
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_hello(uint32_t client_version, uint32_t client_capabilities, protocol_info &info){
+        uint32_t capabilities;
+        if(handle_get_capabilities(capabilities) != STATUS_OK) return STATUS_ERROR;
+
+        m_client_protocol.version = client_version;
+        m_client_protocol.capabilities = client_capabilities & capabilities;
+        m_client_protocol.max_message_size = m_communication->get_max_message_size();
+        m_client_protocol.coverage_map_size = MAP_SIZE;
+
+        info = m_client_protocol;
+        info.version = PROTOCOL_VERSION;
+
+        // All following requests and responses use the native byte order, if both support it.
+        m_communication->set_byte_order((m_client_protocol.capabilities & CAPABILITY_NATIVE_BYTE_ORDER) ? BYTE_ORDER_NATIVE : BYTE_ORDER_BIG_ENDIAN);
+
+        log_info_message("Client with protocol version %u, common capabilities 0x%x.", client_version, m_client_protocol.capabilities);
+
+        return STATUS_OK;
+    }
+
+    void testing_receiver::push_event(event_type type, const char* data, uint32_t data_length){
+        uint64_t timestamp;
+        if(handle_get_simulation_time(timestamp) != STATUS_OK) timestamp = 0;
+
+        m_event_push.push(type, data, data_length, timestamp);
+    }
+
+    status testing_receiver::handle_set_code_coverage_sampling(coverage_sampling sampling, uint32_t period, uint32_t seed){
+
+        if(sampling != SAMPLE_ALL && period == 0){
+            log_error_message("The coverage sampling period must not be zero!");
+            return STATUS_ERROR;
+        }
+
+        log_info_message("Setting coverage sampling mode %d with period %d and seed %d.", (int)sampling, period, seed);
+
+        m_coverage_sampling = sampling;
+        m_coverage_sample_seed = seed;
+
+        // The time based period is given in microseconds.
+        m_coverage_sample_period = sampling == SAMPLE_TIME ? (uint64_t)period * 1000 : period;
+
+        for(size_t i = 0; i < m_coverage_shards.size(); i++) configure_shard_sampling(i);
+
+        return STATUS_OK;
+    }
+
     testing_receiver* testing_receiver::m_instance = nullptr;
 
     void testing_receiver::notify_VP_ERROR_event(){
@@ -158,6 +768,8 @@ namespace testing{
                 m_current_req = m_communication->get_request();
                 m_current_res = response();
 
+                m_communication->record_request(m_current_req);
+
                 log_info_message("Successfully received request with command: %d", (uint8_t)m_current_req.request_command);
 
                 //Handling request
@@ -165,6 +777,8 @@ namespace testing{
 
                 //TODO return status
 
+                m_communication->record_response(m_current_res);
+
                 if(m_communication->send_response(m_current_res)){
                     log_info_message("Successfully sent response for command: %d", (uint8_t)m_current_req.request_command);
                 }else{
@@ -199,6 +813,8 @@ namespace testing{
     }
 
     void testing_receiver::notify_event(event new_event){
+        if(m_event_push.is_pushed(new_event.event)) push_event(new_event.event, new_event.addition_data, new_event.additional_data_length);
+
         m_event_queue.push_back(new_event);
 
         //Notify new event.
@@ -208,8 +824,8 @@ namespace testing{
     void testing_receiver::notify_MMIO_READ_event(uint64_t address, uint32_t length){
         
         char* buffer = (char *)malloc(12);
-        testing_communication::int64_to_bytes(address, buffer, 0);
-        testing_communication::int32_to_bytes(length, buffer, 8);
+        int64_to_bytes(address, buffer, 0);
+        int32_to_bytes(length, buffer, 8);
 
         notify_event(event{MMIO_READ, buffer, 12});
     }
@@ -217,11 +833,44 @@ namespace testing{
     void testing_receiver::notify_MMIO_WRITE_event(uint64_t address, uint32_t length, char* data){
 
         char* buffer = (char *)malloc(12+length);
-        testing_communication::int64_to_bytes(address, buffer, 0);
-        testing_communication::int32_to_bytes(length, buffer, 8);
+        int64_to_bytes(address, buffer, 0);
+        int32_to_bytes(length, buffer, 8);
+        memcpy(buffer+12, data, length);
+
+        notify_event(event{MMIO_WRITE, buffer, 12+length});
+    }
+
+    void testing_receiver::notify_MMIO_READ_event(uint64_t address, uint32_t length, uint32_t range_id){
+
+        char* buffer = (char *)malloc(16);
+        int64_to_bytes(address, buffer, 0);
+        int32_to_bytes(length, buffer, 8);
+        int32_to_bytes(range_id, buffer, 12);
+
+        notify_event(event{MMIO_READ, buffer, 16});
+    }
+
+    void testing_receiver::notify_MMIO_WRITE_event(uint64_t address, uint32_t length, char* data, uint32_t range_id){
+
+        char* buffer = (char *)malloc(16+length);
+        int64_to_bytes(address, buffer, 0);
+        int32_to_bytes(length, buffer, 8);
         memcpy(buffer+12, data, length);
+        int32_to_bytes(range_id, buffer, 12+length);
+
+        notify_event(event{MMIO_WRITE, buffer, 16+length});
+    }
 
-        notify_event(event{MMIO_READ, buffer, 12+length});
+    void testing_receiver::trace_mmio_access(uint64_t address, uint32_t width, const char* value, bool write, uint32_t range_id, uint64_t timestamp){
+        mmio_trace_record record = {};
+        record.timestamp = timestamp;
+        record.address = address;
+        record.width = (uint8_t)(width > 8 ? 8 : width);
+        record.write = write;
+        record.range_id = range_id;
+        memcpy(&record.value, value, record.width);
+
+        m_mmio_trace.append(record);
     }
 
     void testing_receiver::notify_VP_END_event(){
@@ -255,24 +904,426 @@ namespace testing{
     }
 
     void testing_receiver::reset_code_coverage(){
-        // Writes all zeros to the basic block tracing array.
-        memset(m_bb_array, 0, MAP_SIZE*sizeof(uint8_t));
+        // Writes zeros to the touched entries of the basic block tracing maps and restarts the edge and sampling state, so every run starts the same way.
+        for(auto &shard: m_coverage_shards){
+            shard->map.reset();
+            shard->tracker.reset();
+        }
     }
 
     std::string testing_receiver::get_code_coverage(){
         // Copying the bb tracke map to a string.
-        std::vector<uint8_t> v(m_bb_array, m_bb_array + sizeof m_bb_array / sizeof m_bb_array[0]);
-        std::string s(v.begin(), v.end());
+        std::string s(MAP_SIZE, '\0');
+        copy_coverage_to(reinterpret_cast<uint8_t*>(&s[0]));
         return s;
     }
 
     void testing_receiver::set_block(uint64_t pc){
         //Writing to the basic block traching map. 
-        uint64_t curr_bb_loc = (pc >> 4) ^ (pc << 8);
-        curr_bb_loc &= MAP_SIZE - 1;
+        hit_block(register_block(pc));
+    }
+
+    void testing_receiver::set_block(uint64_t pc, size_t shard){
+        hit_block(register_block(pc), shard);
+    }
+
+    bool testing_receiver::set_coverage_shard_count(size_t count){
+        if(count == 0){
+            log_error_message("At least one coverage shard is required!");
+            return false;
+        }
+
+        // New shards start with empty maps, the remaining are reset.
+        m_coverage_shards.resize(count);
+        for(size_t i = 0; i < count; i++){
+            if(m_coverage_shards[i] == nullptr){
+                m_coverage_shards[i] = create_coverage_shard();
+            }else{
+                m_coverage_shards[i]->map.reset();
+            }
+
+            configure_shard_sampling(i);
+        }
+
+        return true;
+    }
+
+    void testing_receiver::configure_shard_sampling(size_t shard){
+        // This also resets the tracker.
+        m_coverage_shards[shard]->tracker.configure_sampling(m_coverage_sampling, m_coverage_sample_period, m_coverage_sample_seed + (uint32_t)shard * 0x9E3779B9);
+    }
+
+    size_t testing_receiver::get_coverage_shard_count(){
+        return m_coverage_shards.size();
+    }
+
+    void testing_receiver::report_run_end(event_type end_event){
+        m_run_result.end_event = end_event;
+
+        if(m_event_push.is_pushed(end_event)) push_event(end_event, nullptr, 0);
+    }
+
+    void testing_receiver::report_run_statistics(uint64_t instruction_count, uint64_t simulation_time){
+        m_run_result.instruction_count = instruction_count;
+        m_run_result.simulation_time = simulation_time;
+    }
+
+    uint64_t testing_receiver::hash_code_coverage(){
+        if(m_coverage_shards.size() == 1) return m_coverage_shards[0]->map.hash();
+
+        m_merged_coverage.resize(MAP_SIZE);
+        copy_coverage_to(m_merged_coverage.data());
+        return coverage_hash(m_merged_coverage.data(), MAP_SIZE);
+    }
+
+    bool testing_receiver::update_seen_code_coverage(){
+        if(m_seen_coverage.data() == nullptr && !allocate_seen_coverage()) return false;
+        uint8_t* seen = reinterpret_cast<uint8_t*>(m_seen_coverage.data());
+
+        if(m_coverage_shards.size() == 1) return m_coverage_shards[0]->map.update_seen(seen);
+
+        m_merged_coverage.resize(MAP_SIZE);
+        copy_coverage_to(m_merged_coverage.data());
+        return coverage_update_seen(seen, m_merged_coverage.data(), MAP_SIZE);
+    }
+
+    bool testing_receiver::update_global_code_coverage(){
+        uint8_t* global = reinterpret_cast<uint8_t*>(m_global_coverage.data());
+
+        if(m_coverage_shards.size() == 1) return m_coverage_shards[0]->map.update_seen_shared(global);
+
+        // The shards were merged by update_seen_code_coverage.
+        return coverage_update_seen_shared(global, m_merged_coverage.data(), MAP_SIZE);
+    }
+
+    status testing_receiver::handle_attach_global_coverage(std::string &name){
+        if(name.empty()){
+            m_global_coverage.close();
+            return STATUS_OK;
+        }
+
+        if(!m_global_coverage.open(name, false)){
+            log_error_message("Failed to map global coverage %s: %s", name.c_str(), strerror(errno));
+            return STATUS_ERROR;
+        }
+
+        if(m_global_coverage.size() < MAP_SIZE){
+            log_error_message("Global coverage %s is smaller than the coverage map!", name.c_str());
+            m_global_coverage.close();
+            return STATUS_ERROR;
+        }
+
+        return STATUS_OK;
+    }
+
+    void testing_receiver::begin_run(){
+        // The status is ignored, because the VP may not have coverage enabled.
+        handle_reset_code_coverage();
+        m_run_result = run_result();
+
+        begin_run_budget();
+    }
+
+    status testing_receiver::handle_set_run_budget(const run_budget &budget){
+        if(budget.stall_blocks != 0 && !COVERAGE_DIRTY_TRACKING){
+            log_error_message("The loop detection needs COVERAGE_DIRTY_TRACKING!");
+            return STATUS_ERROR;
+        }
 
-        m_bb_array[curr_bb_loc ^ m_prev_bb_loc]++;
-        m_prev_bb_loc = curr_bb_loc >> 1;
+        m_run_budget = budget;
+        m_run_budget_enabled = budget.instructions != 0 || budget.simulation_time != 0 || budget.blocks != 0 || budget.wall_time != 0 || budget.stall_blocks != 0;
+
+        return STATUS_OK;
+    }
+
+    void testing_receiver::begin_run_budget(){
+        m_run_budget_exhausted = false;
+        if(!m_run_budget_enabled) return;
+
+        m_instruction_limit = m_run_budget.instructions != 0 ? m_run_budget.instructions : UINT64_MAX;
+        m_simulation_time_limit = m_run_budget.simulation_time != 0 ? m_run_budget.simulation_time : UINT64_MAX;
+
+        // The block counts are only reset with the coverage, so the limits are relative to the counts at the start of the run.
+        m_run_start_blocks = total_block_count();
+        m_block_limit = m_run_budget.blocks != 0 ? m_primary_tracker->get_block_count() + m_run_budget.blocks : UINT64_MAX;
+
+        m_run_start_time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        m_run_budget_countdown = RUN_BUDGET_CHECK_STRIDE;
+
+        m_run_hit_entries = 0;
+        for(auto &shard: m_coverage_shards) m_run_hit_entries += shard->map.hit_entry_count();
+        m_run_progress_blocks = m_run_start_blocks;
+    }
+
+    bool testing_receiver::check_run_budget_periodic(){
+        m_run_budget_countdown = RUN_BUDGET_CHECK_STRIDE;
+        if(m_run_budget_exhausted) return true;
+
+        uint64_t blocks = total_block_count();
+        if(m_run_budget.blocks != 0 && blocks - m_run_start_blocks >= m_run_budget.blocks) return exhaust_run_budget();
+
+        if(m_run_budget.wall_time != 0){
+            uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            if(now - m_run_start_time >= m_run_budget.wall_time * 1000) return exhaust_run_budget();
+        }
+
+        // A run that executes stall_blocks blocks without hitting a new map entry repeats the same edges, so it is most likely stuck in a loop.
+        if(m_run_budget.stall_blocks != 0){
+            size_t hit_entries = 0;
+            for(auto &shard: m_coverage_shards) hit_entries += shard->map.hit_entry_count();
+
+            if(hit_entries != m_run_hit_entries){
+                m_run_hit_entries = hit_entries;
+                m_run_progress_blocks = blocks;
+            }else if(blocks - m_run_progress_blocks >= m_run_budget.stall_blocks){
+                return exhaust_run_budget();
+            }
+        }
+
+        return false;
+    }
+
+    bool testing_receiver::exhaust_run_budget(){
+        if(!m_run_budget_exhausted){
+            m_run_budget_exhausted = true;
+            report_run_end(HANG);
+        }
+
+        return true;
+    }
+
+    uint64_t testing_receiver::total_block_count(){
+        uint64_t blocks = 0;
+        for(auto &shard: m_coverage_shards) blocks += shard->tracker.get_block_count();
+        return blocks;
+    }
+
+    void testing_receiver::complete_run(){
+        uint64_t return_code;
+        if(handle_get_return_code(return_code) == STATUS_OK) m_run_result.return_code = return_code;
+
+        complete_run_coverage();
+
+        // The trace of the run is complete.
+        m_mmio_trace.flush();
+    }
+
+    void testing_receiver::complete_run_coverage(){
+        m_run_result.coverage_hash = hash_code_coverage();
+        m_run_result.new_coverage = update_seen_code_coverage();
+        if(m_global_coverage.data() != nullptr) m_run_result.new_global_coverage = update_global_code_coverage();
+
+        m_run_result.block_count = total_block_count();
+    }
+
+    void testing_receiver::begin_single_run(){
+        if(m_run_options & RUN_OPTION_RESULT_RECORD){
+            begin_run();
+        }else{
+            begin_run_budget();
+        }
+    }
+
+    void testing_receiver::complete_single_run(response &res){
+        res.data = nullptr;
+        res.data_length = 0;
+
+        if(!(m_run_options & RUN_OPTION_RESULT_RECORD)){
+            // The trace of the run is complete, also without a result record.
+            m_mmio_trace.flush();
+            return;
+        }
+
+        complete_run();
+        write_run_result_record(res);
+    }
+
+    void testing_receiver::write_run_result_record(response &res){
+
+        // Record:
+        // (8 Bytes) Return code
+        // (1 Bytes) Terminating event
+        // (1 Bytes) New coverage flag
+        // (1 Bytes) New global coverage flag
+        // (5 Bytes) Reserved
+        // (8 Bytes) Executed blocks
+        // (8 Bytes) Executed instructions
+        // (8 Bytes) Simulated time in picoseconds
+        // (8 Bytes) Coverage hash
+
+        res.data_length = RUN_RESULT_RECORD_SIZE;
+        res.data = (char*)malloc(res.data_length);
+
+        int64_to_bytes(m_run_result.return_code, res.data, 0);
+        res.data[8] = (char)m_run_result.end_event;
+        res.data[9] = (char)m_run_result.new_coverage;
+        res.data[10] = (char)m_run_result.new_global_coverage;
+        memset(res.data + 11, 0, 5);
+
+        const uint64_t counters[4] = {m_run_result.block_count, m_run_result.instruction_count, m_run_result.simulation_time, m_run_result.coverage_hash};
+        store_uint64_array(counters, 4, res.data + 16, data_byte_order());
+    }
+
+    void testing_receiver::write_run_batch_record(char* buffer, status run_status){
+
+        // Record:
+        // (8 Bytes) Return code
+        // (1 Bytes) Status of the run
+        // (1 Bytes) Terminating event
+        // (1 Bytes) New coverage flag
+        // (1 Bytes) New global coverage flag
+        // (4 Bytes) Reserved
+        // (8 Bytes) Coverage hash
+
+        int64_to_bytes(m_run_result.return_code, buffer, 0);
+        buffer[8] = (char)run_status;
+        buffer[9] = (char)m_run_result.end_event;
+        buffer[10] = (char)m_run_result.new_coverage;
+        buffer[11] = (char)m_run_result.new_global_coverage;
+        memset(buffer + 12, 0, 4);
+        int64_to_bytes(m_run_result.coverage_hash, buffer, 16);
+    }
+
+    coverage_map& testing_receiver::get_coverage_map(size_t shard){
+        return m_coverage_shards[shard]->map;
+    }
+
+    const protocol_info& testing_receiver::get_client_protocol() const {
+        return m_client_protocol;
+    }
+
+    mmio_range_index& testing_receiver::get_mmio_tracking_ranges(){
+        return m_mmio_tracking_ranges;
+    }
+
+    status testing_receiver::handle_add_mmio_tracking_range(uint32_t id, uint64_t start_address, uint64_t end_address, char mode){
+        if(mode < TRACK_READ_WRITE || mode > TRACK_WRITE){
+            log_error_message("Unknown MMIO tracking mode %d!", mode);
+            return STATUS_ERROR;
+        }
+
+        if(!m_mmio_tracking_ranges.add(id, start_address, end_address, (mmio_tracking_mode)mode)){
+            log_error_message("MMIO tracking range %d is invalid, already exists or overlaps another range!", id);
+            return STATUS_ERROR;
+        }
+
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_remove_mmio_tracking_range(uint32_t id){
+        if(!m_mmio_tracking_ranges.remove(id)){
+            log_error_message("MMIO tracking range %d does not exist!", id);
+            return STATUS_ERROR;
+        }
+
+        return STATUS_OK;
+    }
+
+    fixed_read_table& testing_receiver::get_fixed_reads(){
+        return m_fixed_reads;
+    }
+
+    status testing_receiver::handle_set_fixed_read(size_t count, char* data){
+        m_fixed_reads.clear();
+
+        // Each entry: 8 bytes address, 1 byte data.
+        for(size_t i = 0; i < count; i++){
+            m_fixed_reads.set(bytes_to_int64(data, i*9), &data[i*9+8], 1);
+        }
+
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_set_fixed_read_wide(size_t count, char* data){
+        m_fixed_reads.clear();
+
+        // Each entry: 8 bytes address, 1 byte width, width bytes value.
+        size_t offset = 0;
+        for(size_t i = 0; i < count; i++){
+            uint8_t width = data[offset+8];
+            m_fixed_reads.set(bytes_to_int64(data, offset), &data[offset+9], width);
+            offset += 9 + width;
+        }
+
+        return STATUS_OK;
+    }
+
+    mmio_read_queue& testing_receiver::get_mmio_read_queue(){
+        return m_mmio_read_queue;
+    }
+
+    status testing_receiver::handle_add_to_mmio_read_queue(uint64_t address, size_t, size_t data_length, char* data){
+        m_mmio_read_queue.push(address, data, data_length);
+        return STATUS_OK;
+    }
+
+    memory_snapshot& testing_receiver::get_memory_snapshot(){
+        return m_memory_snapshot;
+    }
+
+    status testing_receiver::handle_prepare_run(prepared_run &){
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_run_prepared(prepared_run &run, size_t mmio_data_length, char* mmio_data){
+        return handle_do_run(run.start_breakpoint, run.end_breakpoint, run.mmio_address, run.mmio_length, mmio_data_length, mmio_data, run.register_name);
+    }
+
+    status testing_receiver::handle_snapshot_create(){
+        if(!m_memory_snapshot.has_regions()){
+            log_error_message("Snapshots are not supported, no guest memory regions registered.");
+            return STATUS_ERROR;
+        }
+
+        if(handle_store_cpu_register() != STATUS_OK) return STATUS_ERROR;
+
+        if(!m_memory_snapshot.create()){
+            log_error_message("Creating the memory snapshot failed.");
+            return STATUS_ERROR;
+        }
+
+        return STATUS_OK;
+    }
+
+    status testing_receiver::handle_snapshot_restore(uint32_t &restored_pages){
+        restored_pages = 0;
+
+        if(!m_memory_snapshot.has_snapshot()){
+            log_error_message("No snapshot to restore.");
+            return STATUS_ERROR;
+        }
+
+        if(!m_memory_snapshot.restore()){
+            log_error_message("Restoring the memory snapshot failed.");
+            return STATUS_ERROR;
+        }
+
+        restored_pages = (uint32_t)m_memory_snapshot.get_restored_page_count();
+
+        return handle_restore_cpu_register();
+    }
+
+    testing_receiver::coverage_shard_ptr testing_receiver::create_coverage_shard(){
+        void* memory = mmap(nullptr, sizeof(coverage_shard), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if(memory == MAP_FAILED) throw std::bad_alloc();
+
+        // Placed before the constructor touches the pages.
+        place_buffer(memory, sizeof(coverage_shard));
+
+        return coverage_shard_ptr(new (memory) coverage_shard());
+    }
+
+    void testing_receiver::coverage_shard_deleter::operator()(coverage_shard* shard) const {
+        shard->~coverage_shard();
+        munmap(shard, sizeof(coverage_shard));
+    }
+
+    void testing_receiver::copy_coverage_to(uint8_t* dest){
+        // The first shard is copied, all other shards are added with saturation.
+        m_coverage_shards[0]->map.copy_to(dest);
+        for(size_t i = 1; i < m_coverage_shards.size(); i++){
+            m_coverage_shards[i]->map.merge_into(dest);
+        }
     }
 
     bool testing_receiver::check_exact_request_length(request &req, response &res, size_t length){
@@ -356,45 +1407,173 @@ namespace testing{
                 break;
             }
 
-            case REMOVE_BREAKPOINT:
+            case REMOVE_BREAKPOINT:
+            {
+                // Expect minimum 1 bytes of data:  min. one character 
+                if(!check_min_request_length(req, res, 1)) return;
+                
+                // The length of the symbol name is determined by the data length. So not additional length checking is required.
+                std::string symbol_name(req.data, req.data_length);
+
+                res.response_status = handle_remove_breakpoint(symbol_name);
+                res.data_length = 0;
+                res.data = nullptr;
+
+                break;
+            }
+
+            case ENABLE_MMIO_TRACKING:
+            {
+                // Expect minimum 9 bytes of data: 8 bytes start address, 8 bytes end address, 1 byte mode.
+                if(!check_exact_request_length(req, res, 17)) return;
+
+                uint64_t start_address = bytes_to_int64(req.data, 0);
+                uint64_t end_address = bytes_to_int64(req.data, 8);
+                char mode = req.data[16];
+
+                res.response_status = handle_enable_mmio_tracking(start_address, end_address, mode);
+                res.data = nullptr;
+                res.data_length = 0;
+
+                break;
+            }
+
+            case DISABLE_MMIO_TRACKING:
+            {
+                if(!check_exact_request_length(req, res, 0)) return;
+
+                res.response_status = handle_disable_mmio_tracking();
+                res.data = nullptr;
+                res.data_length = 0;
+                
+                break;
+            }
+
+            case ADD_MMIO_TRACKING_RANGE:
+            {
+                // Expect 21 bytes of data: 4 bytes ID, 8 bytes start address, 8 bytes end address, 1 byte mode.
+                if(!check_exact_request_length(req, res, 21)) return;
+
+                uint32_t id = bytes_to_int32(req.data, 0);
+                uint64_t start_address = bytes_to_int64(req.data, 4);
+                uint64_t end_address = bytes_to_int64(req.data, 12);
+                char mode = req.data[20];
+
+                res.response_status = handle_add_mmio_tracking_range(id, start_address, end_address, mode);
+                res.data = nullptr;
+                res.data_length = 0;
+
+                break;
+            }
+
+            case REMOVE_MMIO_TRACKING_RANGE:
+            {
+                // Expect 4 bytes of data: ID.
+                if(!check_exact_request_length(req, res, 4)) return;
+
+                uint32_t id = bytes_to_int32(req.data, 0);
+
+                res.response_status = handle_remove_mmio_tracking_range(id);
+                res.data = nullptr;
+                res.data_length = 0;
+
+                break;
+            }
+
+            case ENABLE_MMIO_TRACE:
+            {
+                // Expect 10 bytes of data: 4 bytes shared memory ID, 4 bytes offset, 1 byte encoding, 1 byte policy.
+                if(!check_exact_request_length(req, res, 10)) return;
+
+                int shm_id = bytes_to_int32(req.data, 0);
+                uint32_t offset = bytes_to_int32(req.data, 4);
+                uint8_t encoding = req.data[8];
+                uint8_t policy = req.data[9];
+
+                if(encoding > TRACE_DELTA || policy > TRACE_BACKPRESSURE){
+                    log_error_message("Unknown MMIO trace encoding %d or policy %d!", encoding, policy);
+                    testing_communication::respond_malformed(res);
+                    return;
+                }
+
+                res.response_status = handle_enable_mmio_trace(shm_id, offset, (mmio_trace_encoding)encoding, (mmio_trace_policy)policy);
+                res.data = nullptr;
+                res.data_length = 0;
+
+                break;
+            }
+
+            case DISABLE_MMIO_TRACE:
+            {
+                if(!check_exact_request_length(req, res, 0)) return;
+
+                res.response_status = handle_disable_mmio_trace();
+                res.data = nullptr;
+                res.data_length = 0;
+
+                break;
+            }
+
+            case ENABLE_EVENT_PUSH:
             {
-                // Expect minimum 1 bytes of data:  min. one character 
-                if(!check_min_request_length(req, res, 1)) return;
-                
-                // The length of the symbol name is determined by the data length. So not additional length checking is required.
-                std::string symbol_name(req.data, req.data_length);
 
-                res.response_status = handle_remove_breakpoint(symbol_name);
+                // Content:
+                // (4 Bytes) Shared memory ID +
+                // (4 Bytes) Offset of the event ring +
+                // (4 Bytes) Offset of the wakeup word (EVENT_PUSH_NO_WAKEUP for none) +
+                // (4 Bytes) Event mask (bit 1 << event type)
+
+                if(!check_exact_request_length(req, res, 16)) return;
+
+                int shm_id = bytes_to_int32(req.data, 0);
+                uint32_t offset = bytes_to_int32(req.data, 4);
+                uint32_t wakeup_offset = bytes_to_int32(req.data, 8);
+                uint32_t event_mask = bytes_to_int32(req.data, 12);
+
+                res.response_status = handle_enable_event_push(shm_id, offset, wakeup_offset, event_mask);
+
+                // No data to be returned.
                 res.data_length = 0;
                 res.data = nullptr;
 
                 break;
             }
 
-            case ENABLE_MMIO_TRACKING:
+            case DISABLE_EVENT_PUSH:
             {
-                // Expect minimum 9 bytes of data: 8 bytes start address, 8 bytes end address, 1 byte mode.
-                if(!check_exact_request_length(req, res, 17)) return;
-
-                uint64_t start_address = testing_communication::bytes_to_int64(req.data, 0);
-                uint64_t end_address = testing_communication::bytes_to_int64(req.data, 8);
-                char mode = req.data[16];
+                if(!check_exact_request_length(req, res, 0)) return;
 
-                res.response_status = handle_enable_mmio_tracking(start_address, end_address, mode);
+                res.response_status = handle_disable_event_push();
                 res.data = nullptr;
                 res.data_length = 0;
 
                 break;
             }
 
-            case DISABLE_MMIO_TRACKING:
+            case HELLO:
             {
-                if(!check_exact_request_length(req, res, 0)) return;
 
-                res.response_status = handle_disable_mmio_tracking();
-                res.data = nullptr;
-                res.data_length = 0;
-                
+                // Content:
+                // (4 Bytes) Protocol version of the client +
+                // (4 Bytes) Capabilities of the client
+
+                if(!check_exact_request_length(req, res, 8)) return;
+
+                // HELLO is always big endian, handle_hello sets the byte order of the following requests.
+                uint32_t client_version = load_uint32(req.data, BYTE_ORDER_BIG_ENDIAN);
+                uint32_t client_capabilities = load_uint32(req.data + 4, BYTE_ORDER_BIG_ENDIAN);
+
+                protocol_info info;
+                res.response_status = handle_hello(client_version, client_capabilities, info);
+
+                // Response: protocol version, common capabilities, maximum message size and coverage map size.
+                res.data_length = 16;
+                res.data = (char*)malloc(res.data_length);
+                store_uint32(info.version, res.data, BYTE_ORDER_BIG_ENDIAN);
+                store_uint32(info.capabilities, res.data + 4, BYTE_ORDER_BIG_ENDIAN);
+                store_uint32(info.max_message_size, res.data + 8, BYTE_ORDER_BIG_ENDIAN);
+                store_uint32(info.coverage_map_size, res.data + 12, BYTE_ORDER_BIG_ENDIAN);
+
                 break;
             }
 
@@ -415,9 +1594,9 @@ namespace testing{
                 // Expect minimum 15 bytes of data: 8 bytes address, 4 bytes length, 4 byte data length + at least one byte data.
                 if(!check_min_request_length(req, res, 17)) return;
 
-                uint64_t address = testing_communication::bytes_to_int64(req.data, 0);
-                uint32_t length = testing_communication::bytes_to_int32(req.data, 8);
-                uint32_t data_length = testing_communication::bytes_to_int32(req.data, 12);
+                uint64_t address = bytes_to_int64(req.data, 0);
+                uint32_t length = bytes_to_int32(req.data, 8);
+                uint32_t data_length = bytes_to_int32(req.data, 12);
 
                 // Check if the total length matches
                 if(!check_exact_request_length(req, res, 16+data_length)) return;
@@ -433,8 +1612,8 @@ namespace testing{
             {   
                 if(!check_exact_request_length(req, res, 16)) return;
                 
-                uint64_t interrupt_address = testing_communication::bytes_to_int64(req.data, 0);
-                uint64_t trigger_address = testing_communication::bytes_to_int64(req.data, 8);
+                uint64_t interrupt_address = bytes_to_int64(req.data, 0);
+                uint64_t trigger_address = bytes_to_int64(req.data, 8);
 
                 res.response_status = handle_set_cpu_interrupt_trigger(interrupt_address, trigger_address);
                 res.data = nullptr;
@@ -475,7 +1654,7 @@ namespace testing{
 
                 if(coverage != nullptr){
                     res.data = (char*)malloc(coverage->size()+4);
-                    testing_communication::int32_to_bytes(coverage->size(), res.data, 0);
+                    int32_to_bytes(coverage->size(), res.data, 0);
                     memcpy(res.data+4, coverage->c_str(), coverage->size());
                     res.data_length = coverage->size()+4;
                 }else{
@@ -491,8 +1670,8 @@ namespace testing{
                 // Min of 8 bytes length: shm_id and offset 4 bytes each.
                 if(!check_exact_request_length(req, res, 8)) return;
 
-                uint32_t shm_id = testing_communication::bytes_to_int32(req.data, 0);
-                uint32_t offset = testing_communication::bytes_to_int32(req.data, 4);
+                uint32_t shm_id = bytes_to_int32(req.data, 0);
+                uint32_t offset = bytes_to_int32(req.data, 4);
 
                 res.response_status = handle_get_code_coverage_shm(shm_id, offset);
                 res.data = nullptr;
@@ -501,6 +1680,72 @@ namespace testing{
                 break;
             }
 
+            case SET_RUN_OPTIONS:
+            {
+                // Expect 1 byte of data: option flags.
+                if(!check_exact_request_length(req, res, 1)) return;
+
+                res.response_status = handle_set_run_options((uint8_t)req.data[0]);
+                res.data = nullptr;
+                res.data_length = 0;
+
+                break;
+            }
+
+            case SET_RUN_BUDGET:
+            {
+
+                // Content:
+                // (8 Bytes) Executed instructions +
+                // (8 Bytes) Simulated time in picoseconds +
+                // (8 Bytes) Executed blocks +
+                // (8 Bytes) Wall time in microseconds +
+                // (8 Bytes) Blocks without new coverage (loop detection)
+                // 0 means no limit.
+
+                if(!check_exact_request_length(req, res, 40)) return;
+
+                run_budget budget;
+                budget.instructions = bytes_to_int64(req.data, 0);
+                budget.simulation_time = bytes_to_int64(req.data, 8);
+                budget.blocks = bytes_to_int64(req.data, 16);
+                budget.wall_time = bytes_to_int64(req.data, 24);
+                budget.stall_blocks = bytes_to_int64(req.data, 32);
+
+                res.response_status = handle_set_run_budget(budget);
+
+                // No data to be returned.
+                res.data_length = 0;
+                res.data = nullptr;
+
+                break;
+            }
+
+            case SET_CODE_COVERAGE_SAMPLING:
+            {
+                // Content:
+                // (1 Bytes) Sampling mode (0: all blocks, 1: every Nth block, 2: time based)
+                // (4 Bytes) Period (blocks or microseconds)
+                // (4 Bytes) Seed
+                if(!check_exact_request_length(req, res, 9)) return;
+
+                uint8_t sampling = req.data[0];
+                uint32_t period = bytes_to_int32(req.data, 1);
+                uint32_t seed = bytes_to_int32(req.data, 5);
+
+                if(sampling > SAMPLE_TIME){
+                    log_error_message("Unknown coverage sampling mode %d!", sampling);
+                    testing_communication::respond_malformed(res);
+                    return;
+                }
+
+                res.response_status = handle_set_code_coverage_sampling((coverage_sampling)sampling, period, seed);
+                res.data = nullptr;
+                res.data_length = 0;
+
+                break;
+            }
+
             case RESET_CODE_COVERAGE:
             {
                 if(!check_exact_request_length(req, res, 0)) return;
@@ -518,7 +1763,7 @@ namespace testing{
                 // Expect minimum 1 bytes of data: 4 bytes address, min. 1 byte reg name
                 if(!check_min_request_length(req, res, 5)) return;
 
-                uint64_t address = testing_communication::bytes_to_int64(req.data, 0);
+                uint64_t address = bytes_to_int64(req.data, 0);
                 // The length of the symbol name is determined by the data length without the address. So not additional length checking is required.
                 std::string reg_name(req.data + 4, req.data_length-4);
 
@@ -533,11 +1778,19 @@ namespace testing{
             {   
                 if(!check_exact_request_length(req, res, 0)) return;
 
-                uint64_t exit_code;
-                res.response_status = handle_get_return_code(exit_code);               
+                // The parent of the fork server is still at the start breakpoint, the return code was captured by the child.
+                uint64_t exit_code = 0;
+                if(m_fork_server){
+                    fork_server_state* state = reinterpret_cast<fork_server_state*>(m_fork_server_state.data());
+                    exit_code = state->return_code;
+                    res.response_status = state->return_code_valid ? STATUS_OK : STATUS_ERROR;
+                }else{
+                    res.response_status = handle_get_return_code(exit_code);
+                }
+
                 res.data_length = sizeof(uint64_t);
                 res.data = (char*)malloc(res.data_length); 
-                testing_communication::int64_to_bytes(exit_code, res.data, 0);
+                int64_to_bytes(exit_code, res.data, 0);
 
                 break;
             }
@@ -560,9 +1813,9 @@ namespace testing{
                 // Min of 20 bytes length (least one byte of data).
                 if(!check_min_request_length(req, res, 20)) return;
 
-                uint64_t address = testing_communication::bytes_to_int64(req.data, 0);
-                uint32_t length = testing_communication::bytes_to_int32(req.data, 8);
-                uint32_t data_length = testing_communication::bytes_to_int32(req.data, 12);
+                uint64_t address = bytes_to_int64(req.data, 0);
+                uint32_t length = bytes_to_int32(req.data, 8);
+                uint32_t data_length = bytes_to_int32(req.data, 12);
 
                 uint8_t start_breakpoint_length = req.data[16];
                 uint8_t end_breakpoint_length = req.data[17];
@@ -575,9 +1828,94 @@ namespace testing{
                 std::string end_breakpoint(&req.data[start_breakpoint_length+19], end_breakpoint_length);
                 std::string register_name(&req.data[start_breakpoint_length+end_breakpoint_length+19], register_name_length);
 
-                res.response_status = handle_do_run(start_breakpoint, end_breakpoint, address, length, data_length, &req.data[19+start_breakpoint_length+end_breakpoint_length+register_name_length], register_name);
-                res.data = nullptr;
-                res.data_length = 0;
+                execute_single_run(res, [&]{
+                    std::string run_start = run_start_breakpoint(start_breakpoint);
+                    return handle_do_run(run_start, end_breakpoint, address, length, data_length, &req.data[19+start_breakpoint_length+end_breakpoint_length+register_name_length], register_name);
+                });
+
+                break;
+            }
+
+            case PREPARE_RUN:
+            {
+
+                // Content:
+                // (8 Bytes) MMIO address +
+                // (4 Bytes) MMIO length +
+                // (1 Bytes) Start breakpoint name length +
+                // (1 Bytes) End breakpoint name length +
+                // (1 Bytes) Register name length +
+                // (? Bytes) Start breakpoint name +
+                // (? Bytes) End breakpoint name +
+                // (? Bytes) Return register name
+
+                if(!check_min_request_length(req, res, 15)) return;
+
+                prepared_run run;
+                run.mmio_address = bytes_to_int64(req.data, 0);
+                run.mmio_length = bytes_to_int32(req.data, 8);
+
+                uint8_t start_breakpoint_length = req.data[12];
+                uint8_t end_breakpoint_length = req.data[13];
+                uint8_t register_name_length = req.data[14];
+
+                // Check again with all length combined.
+                if(!check_exact_request_length(req, res, 15+start_breakpoint_length+end_breakpoint_length+register_name_length)) return;
+
+                run.start_breakpoint.assign(&req.data[15], start_breakpoint_length);
+                run.end_breakpoint.assign(&req.data[start_breakpoint_length+15], end_breakpoint_length);
+                run.register_name.assign(&req.data[start_breakpoint_length+end_breakpoint_length+15], register_name_length);
+
+                // Preparing the same run again returns the existing handle, so clients that prepare on every start do not grow the list.
+                uint32_t handle = 0;
+                while(handle < m_prepared_runs.size()){
+                    prepared_run &existing = m_prepared_runs[handle];
+                    if(existing.mmio_address == run.mmio_address && existing.mmio_length == run.mmio_length && existing.start_breakpoint == run.start_breakpoint
+                        && existing.end_breakpoint == run.end_breakpoint && existing.register_name == run.register_name) break;
+                    handle++;
+                }
+
+                if(handle == m_prepared_runs.size()){
+                    res.response_status = handle_prepare_run(run);
+                    if(res.response_status == STATUS_OK) m_prepared_runs.push_back(std::move(run));
+                }else{
+                    res.response_status = STATUS_OK;
+                }
+
+                // Handle of the prepared run.
+                res.data_length = sizeof(uint32_t);
+                res.data = (char*)malloc(res.data_length);
+                int32_to_bytes(handle, res.data, 0);
+
+                break;
+            }
+
+            case RUN_PREPARED:
+            {
+
+                // Content:
+                // (4 Bytes) Handle of the prepared run +
+                // (? Bytes) Data
+
+                // Min of 5 bytes length (least one byte of data).
+                if(!check_min_request_length(req, res, 5)) return;
+
+                uint32_t handle = bytes_to_int32(req.data, 0);
+                if(handle >= m_prepared_runs.size()){
+                    log_error_message("Prepared run %d does not exist!", handle);
+                    res.response_status = STATUS_ERROR;
+                    res.data = nullptr;
+                    res.data_length = 0;
+                    break;
+                }
+
+                execute_single_run(res, [&]{
+                    if(!m_fork_server) return handle_run_prepared(m_prepared_runs[handle], req.data_length - 4, &req.data[4]);
+
+                    prepared_run run = m_prepared_runs[handle];
+                    run.start_breakpoint.clear();
+                    return handle_run_prepared(run, req.data_length - 4, &req.data[4]);
+                });
 
                 break;
             }
@@ -602,10 +1940,10 @@ namespace testing{
                 // Min of 25 bytes length (at least one byte of data).
                 if(!check_min_request_length(req, res, 25)) return;
 
-                uint64_t address = testing_communication::bytes_to_int64(req.data, 0);
-                uint32_t length = testing_communication::bytes_to_int32(req.data, 8);
-                uint32_t shm_id = testing_communication::bytes_to_int32(req.data, 12);
-                uint32_t offset = testing_communication::bytes_to_int32(req.data, 16);
+                uint64_t address = bytes_to_int64(req.data, 0);
+                uint32_t length = bytes_to_int32(req.data, 8);
+                uint32_t shm_id = bytes_to_int32(req.data, 12);
+                uint32_t offset = bytes_to_int32(req.data, 16);
 
                 char stop_after_string_termination = req.data[20];
 
@@ -620,9 +1958,157 @@ namespace testing{
                 std::string end_breakpoint(&req.data[start_breakpoint_length+24], end_breakpoint_length);
                 std::string register_name(&req.data[start_breakpoint_length+end_breakpoint_length+24], register_name_length);
 
-                res.response_status = handle_do_run_shm(start_breakpoint, end_breakpoint, address, length, shm_id, offset, (bool)stop_after_string_termination, register_name);
-                res.data = nullptr;
-                res.data_length = 0;
+                execute_single_run(res, [&]{
+                    std::string run_start = run_start_breakpoint(start_breakpoint);
+                    return handle_do_run_shm(run_start, end_breakpoint, address, length, shm_id, offset, (bool)stop_after_string_termination, register_name);
+                });
+
+                break;
+            }
+
+            case DO_RUN_POSIX_SHM:
+            {
+
+                // Content:
+                // (8 Bytes) MMIO address +
+                // (4 Bytes) MMIO length +
+                // (1 Bytes) Start breakpoint name length +
+                // (1 Bytes) End breakpoint name length +
+                // (1 Bytes) Register name length +
+                // (1 Bytes) Input region name length +
+                // (? Bytes) Start breakpoint name +
+                // (? Bytes) End breakpoint name +
+                // (? Bytes) Return register name +
+                // (? Bytes) Input region name
+
+                if(!check_min_request_length(req, res, 17)) return;
+
+                uint64_t address = bytes_to_int64(req.data, 0);
+                uint32_t length = bytes_to_int32(req.data, 8);
+
+                uint8_t start_breakpoint_length = req.data[12];
+                uint8_t end_breakpoint_length = req.data[13];
+                uint8_t register_name_length = req.data[14];
+                uint8_t region_name_length = req.data[15];
+
+                // Check again with all length combined.
+                if(!check_exact_request_length(req, res, 16+start_breakpoint_length+end_breakpoint_length+register_name_length+region_name_length)) return;
+
+                std::string start_breakpoint(&req.data[16], start_breakpoint_length);
+                std::string end_breakpoint(&req.data[start_breakpoint_length+16], end_breakpoint_length);
+                std::string register_name(&req.data[start_breakpoint_length+end_breakpoint_length+16], register_name_length);
+                std::string region_name(&req.data[start_breakpoint_length+end_breakpoint_length+register_name_length+16], region_name_length);
+
+                execute_single_run(res, [&]{
+                    std::string run_start = run_start_breakpoint(start_breakpoint);
+                    return handle_do_run_posix_shm(run_start, end_breakpoint, address, length, region_name, register_name);
+                });
+
+                break;
+            }
+
+            case DO_RUN_BATCH:
+            {
+
+                // Content:
+                // (8 Bytes) MMIO address +
+                // (4 Bytes) MMIO length +
+                // (4 Bytes) Input shared memory ID +
+                // (4 Bytes) Number of test cases +
+                // (4 Bytes) Offset of the test case table in the input shared memory +
+                // (4 Bytes) Result shared memory ID +
+                // (4 Bytes) Offset of the results in the result shared memory +
+                // (1 Bytes) Write coverage slots +
+                // (1 Bytes) Start breakpoint name length +
+                // (1 Bytes) End breakpoint name length +
+                // (1 Bytes) Register name length +
+                // (? Bytes) Start breakpoint name +
+                // (? Bytes) End breakpoint name +
+                // (? Bytes) Return register name
+
+                if(!check_min_request_length(req, res, 36)) return;
+
+                uint64_t address = bytes_to_int64(req.data, 0);
+                uint32_t length = bytes_to_int32(req.data, 8);
+                uint32_t input_shm_id = bytes_to_int32(req.data, 12);
+                uint32_t case_count = bytes_to_int32(req.data, 16);
+                uint32_t table_offset = bytes_to_int32(req.data, 20);
+                uint32_t result_shm_id = bytes_to_int32(req.data, 24);
+                uint32_t result_offset = bytes_to_int32(req.data, 28);
+
+                char coverage_slots = req.data[32];
+
+                uint8_t start_breakpoint_length = req.data[33];
+                uint8_t end_breakpoint_length = req.data[34];
+                uint8_t register_name_length = req.data[35];
+
+                // Check again with all length combined.
+                if(!check_exact_request_length(req, res, 36+start_breakpoint_length+end_breakpoint_length+register_name_length)) return;
+
+                std::string start_breakpoint(&req.data[36], start_breakpoint_length);
+                std::string end_breakpoint(&req.data[start_breakpoint_length+36], end_breakpoint_length);
+                std::string register_name(&req.data[start_breakpoint_length+end_breakpoint_length+36], register_name_length);
+
+                uint32_t executed_cases = 0;
+                res.response_status = handle_do_run_batch(start_breakpoint, end_breakpoint, address, length, input_shm_id, case_count, table_offset, result_shm_id, result_offset, (bool)coverage_slots, register_name, executed_cases);
+
+                // Number of executed test cases.
+                res.data_length = sizeof(uint32_t);
+                res.data = (char*)malloc(res.data_length);
+                int32_to_bytes(executed_cases, res.data, 0);
+
+                break;
+            }
+
+            case PERSISTENT_RUN:
+            {
+
+                // Content:
+                // (8 Bytes) MMIO address +
+                // (4 Bytes) MMIO length +
+                // (4 Bytes) Input shared memory ID +
+                // (4 Bytes) Offset of the input ring in the input shared memory +
+                // (4 Bytes) Result shared memory ID +
+                // (4 Bytes) Offset of the result ring in the result shared memory +
+                // (4 Bytes) Maximum number of test cases (0 for no limit) +
+                // (1 Bytes) Restore snapshot before each test case +
+                // (1 Bytes) Start breakpoint name length +
+                // (1 Bytes) End breakpoint name length +
+                // (1 Bytes) Register name length +
+                // (? Bytes) Start breakpoint name +
+                // (? Bytes) End breakpoint name +
+                // (? Bytes) Return register name
+
+                if(!check_min_request_length(req, res, 36)) return;
+
+                uint64_t address = bytes_to_int64(req.data, 0);
+                uint32_t length = bytes_to_int32(req.data, 8);
+                uint32_t input_shm_id = bytes_to_int32(req.data, 12);
+                uint32_t input_offset = bytes_to_int32(req.data, 16);
+                uint32_t result_shm_id = bytes_to_int32(req.data, 20);
+                uint32_t result_offset = bytes_to_int32(req.data, 24);
+                uint32_t max_runs = bytes_to_int32(req.data, 28);
+
+                char restore_snapshot = req.data[32];
+
+                uint8_t start_breakpoint_length = req.data[33];
+                uint8_t end_breakpoint_length = req.data[34];
+                uint8_t register_name_length = req.data[35];
+
+                // Check again with all length combined.
+                if(!check_exact_request_length(req, res, 36+start_breakpoint_length+end_breakpoint_length+register_name_length)) return;
+
+                std::string start_breakpoint(&req.data[36], start_breakpoint_length);
+                std::string end_breakpoint(&req.data[start_breakpoint_length+36], end_breakpoint_length);
+                std::string register_name(&req.data[start_breakpoint_length+end_breakpoint_length+36], register_name_length);
+
+                uint32_t executed_cases = 0;
+                res.response_status = handle_persistent_run(start_breakpoint, end_breakpoint, address, length, input_shm_id, input_offset, result_shm_id, result_offset, max_runs, (bool)restore_snapshot, register_name, executed_cases);
+
+                // Number of executed test cases.
+                res.data_length = sizeof(uint32_t);
+                res.data = (char*)malloc(res.data_length);
+                int32_to_bytes(executed_cases, res.data, 0);
 
                 break;
             }
@@ -661,6 +2147,38 @@ namespace testing{
                 break;
             }
 
+            case SET_FIXED_READ_WIDE:
+            {
+                // Expect minimum 2 bytes of data: count.
+                if(!check_min_request_length(req, res, 2)) return;
+
+                // Number of fixed read definitions inside the data.
+                uint16_t count = load_uint16(req.data, data_byte_order());
+
+                // Each entry has an address (8 bytes), a width (1 byte, 1 to 8) and the value (width bytes).
+                size_t offset = 2;
+                for(uint16_t i = 0; i < count; i++){
+                    if(!check_min_request_length(req, res, offset+9)) return;
+
+                    uint8_t width = req.data[offset+8];
+                    if(width == 0 || width > 8){
+                        log_error_message("Invalid fixed read width %d!", width);
+                        testing_communication::respond_malformed(res);
+                        return;
+                    }
+
+                    offset += 9 + width;
+                }
+
+                if(!check_exact_request_length(req, res, offset)) return;
+
+                res.response_status = handle_set_fixed_read_wide(count, &req.data[2]);
+                res.data = nullptr;
+                res.data_length = 0;
+
+                break;
+            }
+
             case GET_CPU_PC:
             {   
                 if(!check_exact_request_length(req, res, 0)) return;
@@ -669,7 +2187,7 @@ namespace testing{
                 res.response_status = handle_get_cpu_pc(cpu_pc);               
                 res.data_length = sizeof(uint64_t);
                 res.data = (char*)malloc(res.data_length); 
-                testing_communication::int64_to_bytes(cpu_pc, res.data, 0);
+                int64_to_bytes(cpu_pc, res.data, 0);
 
                 break;
             }
@@ -678,7 +2196,7 @@ namespace testing{
             {   
                 if(!check_exact_request_length(req, res, 8)) return;
 
-                uint64_t address = testing_communication::bytes_to_int64(req.data, 0);
+                uint64_t address = bytes_to_int64(req.data, 0);
 
                 res.response_status = handle_jump_cpu_to(address);
                 res.data = nullptr;
@@ -709,6 +2227,82 @@ namespace testing{
                 break;
             }
 
+            case SNAPSHOT_CREATE:
+            {   
+                if(!check_exact_request_length(req, res, 0)) return;
+
+                res.response_status = handle_snapshot_create();
+                res.data = nullptr;
+                res.data_length = 0;
+
+                break;
+            }
+
+            case SNAPSHOT_RESTORE:
+            {   
+                if(!check_exact_request_length(req, res, 0)) return;
+
+                uint32_t restored_pages;
+                res.response_status = handle_snapshot_restore(restored_pages);
+
+                // Number of guest memory pages copied back.
+                res.data_length = sizeof(uint32_t);
+                res.data = (char*)malloc(res.data_length);
+                int32_to_bytes(restored_pages, res.data, 0);
+
+                break;
+            }
+
+            case FORK_SERVER:
+            {
+
+                // Content:
+                // (4 Bytes) Timeout of a child in milliseconds (0 for no timeout) +
+                // (1 Bytes) Start breakpoint name length +
+                // (? Bytes) Start breakpoint name
+
+                if(!check_min_request_length(req, res, 5)) return;
+
+                uint32_t timeout_ms = bytes_to_int32(req.data, 0);
+                uint8_t start_breakpoint_length = req.data[4];
+
+                if(!check_exact_request_length(req, res, 5+start_breakpoint_length)) return;
+
+                std::string start_breakpoint(&req.data[5], start_breakpoint_length);
+
+                res.response_status = handle_fork_server(start_breakpoint, timeout_ms);
+
+                // No data to be returned.
+                res.data_length = 0;
+                res.data = nullptr;
+
+                break;
+            }
+
+            case ATTACH_GLOBAL_COVERAGE:
+            {
+
+                // Content:
+                // (1 Bytes) Name length (0 to detach) +
+                // (? Bytes) Name of the shared memory object
+
+                if(!check_min_request_length(req, res, 1)) return;
+
+                uint8_t name_length = req.data[0];
+
+                if(!check_exact_request_length(req, res, 1+name_length)) return;
+
+                std::string name(&req.data[1], name_length);
+
+                res.response_status = handle_attach_global_coverage(name);
+
+                // No data to be returned.
+                res.data_length = 0;
+                res.data = nullptr;
+
+                break;
+            }
+
             default:
             {
                 log_info_message("Command %d not found!", req.request_command);
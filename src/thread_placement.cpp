@@ -0,0 +1,126 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "thread_placement.h"
+
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace testing{
+
+    bool apply_thread_placement(const thread_placement &placement){
+        if(!placement.cpus.empty()){
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+
+            for(int cpu: placement.cpus){
+                if(cpu < 0 || cpu >= CPU_SETSIZE){
+                    errno = EINVAL;
+                    return false;
+                }
+
+                CPU_SET(cpu, &cpu_set);
+            }
+
+            int result = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+            if(result != 0){
+                errno = result;
+                return false;
+            }
+        }
+
+        if(placement.policy >= 0){
+            struct sched_param parameters;
+            memset(&parameters, 0, sizeof(parameters));
+            parameters.sched_priority = placement.priority;
+
+            int result = pthread_setschedparam(pthread_self(), placement.policy, &parameters);
+            if(result != 0){
+                errno = result;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    int numa_node_of_cpu(int cpu){
+        // The node of a CPU is the nodeN entry in its sysfs directory.
+        std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+
+        DIR* directory = opendir(path.c_str());
+        if(directory == nullptr) return -1;
+
+        int node = -1;
+        while(struct dirent* entry = readdir(directory)){
+            if(strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9'){
+                node = atoi(entry->d_name + 4);
+                break;
+            }
+        }
+
+        closedir(directory);
+
+        return node;
+    }
+
+    int current_numa_node(){
+        unsigned int cpu, node;
+        if(syscall(SYS_getcpu, &cpu, &node, nullptr) == -1) return -1;
+
+        return (int)node;
+    }
+
+    bool place_memory(void* start, size_t size, int numa_node, bool huge_pages){
+        if(start == nullptr || size == 0) return true;
+
+        uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+        uintptr_t first = (uintptr_t)start & ~(page_size - 1);
+        uintptr_t last = ((uintptr_t)start + size + page_size - 1) & ~(page_size - 1);
+
+        // Transparent huge pages are only a hint, they may be disabled for the kind of memory.
+        if(huge_pages) madvise((void*)first, last - first, MADV_HUGEPAGE);
+
+        if(numa_node < 0) return true;
+
+        // Preferred instead of bind, so the allocation falls back to other nodes instead of failing.
+        const size_t mask_bits = sizeof(unsigned long) * 8 * 16;
+        if((size_t)numa_node >= mask_bits){
+            errno = EINVAL;
+            return false;
+        }
+
+        unsigned long node_mask[16] = {};
+        node_mask[numa_node / (sizeof(unsigned long) * 8)] = 1UL << (numa_node % (sizeof(unsigned long) * 8));
+
+        return syscall(SYS_mbind, first, last - first, MPOL_PREFERRED, node_mask, mask_bits, MPOL_MF_MOVE) == 0;
+    }
+}
@@ -0,0 +1,111 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Benchmark of the per-run cost of hitting, resetting and reading back the coverage map, with the touched-index log (dirty tracking) compared to the plain memset / memcpy, for different map sizes and coverage densities.
+
+#include "coverage_map.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define RUNS 2000
+
+struct run_cost{
+    double hit_ns = 0;
+    double reset_ns = 0;
+    double readback_ns = 0;
+};
+
+// Simulates RUNS runs that each hit all given indices, read back the map and reset it. Returns the average cost per run.
+template<size_t SIZE, bool DIRTY_TRACKING>
+run_cost measure(const std::vector<uint32_t> &indices, uint8_t* dest, uint64_t &checksum){
+    using clock = std::chrono::steady_clock;
+
+    auto map = std::make_unique<testing::basic_coverage_map<SIZE, DIRTY_TRACKING>>();
+    run_cost cost;
+
+    for(int run = 0; run < RUNS; run++){
+        auto start = clock::now();
+        for(uint32_t index: indices) map->hit(index);
+        auto hit_end = clock::now();
+
+        map->copy_to(dest);
+        auto readback_end = clock::now();
+
+        map->reset();
+        auto reset_end = clock::now();
+
+        checksum += dest[indices[run % indices.size()]];
+
+        cost.hit_ns += std::chrono::duration<double, std::nano>(hit_end - start).count();
+        cost.readback_ns += std::chrono::duration<double, std::nano>(readback_end - hit_end).count();
+        cost.reset_ns += std::chrono::duration<double, std::nano>(reset_end - readback_end).count();
+    }
+
+    cost.hit_ns /= RUNS;
+    cost.readback_ns /= RUNS;
+    cost.reset_ns /= RUNS;
+    return cost;
+}
+
+template<size_t SIZE>
+void benchmark_size(uint64_t &checksum){
+    const double densities[] = {0.001, 0.01, 0.1, 0.5};
+
+    std::vector<uint8_t> dest(SIZE);
+
+    for(double density: densities){
+
+        // Fixed seed, so every configuration hits the same indices.
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<uint32_t> dist(0, SIZE - 1);
+
+        std::vector<uint32_t> indices(std::max<size_t>(1, (size_t)(SIZE * density)));
+        for(uint32_t &index: indices) index = dist(rng);
+
+        run_cost plain = measure<SIZE, false>(indices, dest.data(), checksum);
+        run_cost dirty = measure<SIZE, true>(indices, dest.data(), checksum);
+
+        printf("%8zu %8.1f%% | %10.0f %10.0f %10.0f | %10.0f %10.0f %10.0f | %6.2fx\n",
+            SIZE, density * 100,
+            plain.hit_ns, plain.reset_ns, plain.readback_ns,
+            dirty.hit_ns, dirty.reset_ns, dirty.readback_ns,
+            (plain.reset_ns + plain.readback_ns) / (dirty.reset_ns + dirty.readback_ns));
+    }
+}
+
+int main(){
+    uint64_t checksum = 0;
+
+    printf("Per-run cost in ns (%d runs each).\n", RUNS);
+    printf("%8s %9s | %10s %10s %10s | %10s %10s %10s | %7s\n", "size", "density", "hit", "memset", "memcpy", "hit", "reset", "readback", "speedup");
+    printf("%19s | %32s | %32s |\n", "", "plain map", "touched-index log");
+
+    benchmark_size<1 << 14>(checksum);
+    benchmark_size<1 << 16>(checksum);
+    benchmark_size<1 << 18>(checksum);
+    benchmark_size<1 << 20>(checksum);
+
+    printf("Checksum: %lu\n", (unsigned long)checksum);
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Scaling benchmark of 1..8 writer threads (simulated cores) recording edge coverage, either into one shared map with one shared previous block (the behaviour without shards) or into one shard per thread. Also measures the cost of merging the shards at readback.
+
+#include "coverage_policy.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#define HITS_PER_THREAD 20000000
+#define TRACE_LENGTH 4096
+#define MAX_THREADS 8
+
+using clock_type = std::chrono::steady_clock;
+
+// Map without touched log, because the log is not meant for concurrent writers. The shards use the same map type, so only the effect of sharding is measured.
+using plain_map = testing::basic_coverage_map<MAP_SIZE, false>;
+
+struct shard{
+    plain_map map;
+    testing::coverage_tracker<testing::edge_coverage, plain_map> tracker{map};
+};
+
+// Creates a block trace per thread, which is replayed in a loop.
+std::vector<std::vector<uint32_t>> create_traces(){
+    std::vector<std::vector<uint32_t>> traces(MAX_THREADS);
+    std::mt19937 rng(1234);
+
+    for(auto &trace: traces){
+        // Each core executes a loop over a limited set of blocks, like a real program.
+        std::vector<uint32_t> blocks(256);
+        for(uint32_t &block: blocks) block = rng() & (MAP_SIZE - 1);
+
+        trace.resize(TRACE_LENGTH);
+        for(uint32_t &block: trace) block = blocks[rng() % blocks.size()];
+    }
+
+    return traces;
+}
+
+// Runs the given function in thread_count threads at the same time and returns the hits per second of all threads.
+template<typename FUNC>
+double run_threads(size_t thread_count, FUNC func){
+    std::atomic<bool> start{false};
+    std::vector<std::thread> threads;
+
+    for(size_t t = 0; t < thread_count; t++){
+        threads.emplace_back([&start, &func, t]{
+            while(!start.load(std::memory_order_acquire)){}
+            func(t);
+        });
+    }
+
+    auto begin = clock_type::now();
+    start.store(true, std::memory_order_release);
+    for(auto &thread: threads) thread.join();
+    double seconds = std::chrono::duration<double>(clock_type::now() - begin).count();
+
+    return (double)thread_count * HITS_PER_THREAD / seconds;
+}
+
+int main(){
+    auto traces = create_traces();
+
+    printf("Edge coverage writers, %d hits per thread. Hardware threads: %u.\n", HITS_PER_THREAD, std::thread::hardware_concurrency());
+    printf("%7s | %14s | %14s | %8s | %12s\n", "threads", "shared Mhit/s", "shards Mhit/s", "speedup", "merge ns");
+
+    std::vector<uint8_t> readback(MAP_SIZE);
+
+    for(size_t thread_count = 1; thread_count <= MAX_THREADS; thread_count++){
+
+        // One map and one previous block for all threads.
+        auto map = std::make_unique<plain_map>();
+        testing::coverage_tracker<testing::edge_coverage, plain_map> shared_tracker(*map);
+
+        double shared_rate = run_threads(thread_count, [&](size_t t){
+            const std::vector<uint32_t> &trace = traces[t];
+            for(size_t i = 0; i < HITS_PER_THREAD; i++) shared_tracker.hit_block(trace[i % TRACE_LENGTH]);
+        });
+
+        // One shard per thread.
+        std::vector<std::unique_ptr<shard>> shards;
+        for(size_t t = 0; t < thread_count; t++) shards.push_back(std::make_unique<shard>());
+
+        double shard_rate = run_threads(thread_count, [&](size_t t){
+            const std::vector<uint32_t> &trace = traces[t];
+            testing::coverage_tracker<testing::edge_coverage, plain_map> &tracker = shards[t]->tracker;
+            for(size_t i = 0; i < HITS_PER_THREAD; i++) tracker.hit_block(trace[i % TRACE_LENGTH]);
+        });
+
+        // Readback as done by GET_CODE_COVERAGE(_SHM).
+        auto begin = clock_type::now();
+        shards[0]->map.copy_to(readback.data());
+        for(size_t t = 1; t < thread_count; t++) shards[t]->map.merge_into(readback.data());
+        double merge_ns = std::chrono::duration<double, std::nano>(clock_type::now() - begin).count();
+
+        printf("%7zu | %14.1f | %14.1f | %7.2fx | %12.0f\n", thread_count, shared_rate / 1e6, shard_rate / 1e6, shard_rate / shared_rate, merge_ns);
+    }
+
+    return 0;
+}
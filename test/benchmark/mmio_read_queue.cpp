@@ -0,0 +1,127 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Benchmark of the reads per second of the MMIO read queue, compared to a std::map of std::deque (the typical per-VP implementation). Each run refills the queues with the run data (like DO_RUN) and then reads them in 4 byte reads, spread over a number of addresses.
+
+#include "mmio_read_queue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <random>
+#include <vector>
+
+#define RUNS 2000
+#define RUN_DATA_LENGTH 4096
+#define READ_LENGTH 4
+
+using clock_type = std::chrono::steady_clock;
+
+// Baseline: one std::deque per address in a std::map.
+class map_read_queue{
+    public:
+        void push(uint64_t address, const char* data, size_t length){
+            std::deque<char> &queue = m_queues[address];
+            queue.insert(queue.end(), data, data + length);
+        }
+
+        size_t read(uint64_t address, char* dest, size_t length){
+            auto it = m_queues.find(address);
+            if(it == m_queues.end()) return 0;
+
+            size_t count = 0;
+            while(count < length && !it->second.empty()){
+                dest[count++] = it->second.front();
+                it->second.pop_front();
+            }
+            return count;
+        }
+
+    private:
+        std::map<uint64_t, std::deque<char>> m_queues;
+};
+
+// Refills all addresses and reads the queues empty, RUNS times. Returns the reads per second.
+template<typename QUEUE, typename REFILL>
+double measure(QUEUE &queue, const std::vector<uint64_t> &addresses, const std::vector<uint64_t> &read_order, const std::vector<char> &run_data, REFILL refill, uint64_t &checksum){
+    char value[READ_LENGTH];
+    size_t reads = 0;
+
+    auto begin = clock_type::now();
+    for(int run = 0; run < RUNS; run++){
+        size_t chunk = run_data.size() / addresses.size();
+        for(size_t i = 0; i < addresses.size(); i++) refill(queue, addresses[i], run_data.data() + i * chunk, chunk);
+
+        for(uint64_t address: read_order){
+            if(queue.read(address, value, READ_LENGTH) == READ_LENGTH){
+                checksum += (uint8_t)value[0];
+                reads++;
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(clock_type::now() - begin).count();
+
+    return reads / seconds;
+}
+
+int main(){
+    uint64_t checksum = 0;
+
+    std::vector<char> run_data(RUN_DATA_LENGTH);
+    std::mt19937 rng(7);
+    for(char &byte: run_data) byte = (char)rng();
+
+    printf("%d byte reads of %d bytes run data, %d runs.\n", READ_LENGTH, RUN_DATA_LENGTH, RUNS);
+    printf("%9s | %14s | %14s | %14s | %8s\n", "addresses", "map Mread/s", "copy Mread/s", "view Mread/s", "speedup");
+
+    for(size_t address_count: {1, 8, 64}){
+        std::vector<uint64_t> addresses;
+        for(size_t i = 0; i < address_count; i++) addresses.push_back(0x40000000 + i * 0x1000);
+
+        // Reads in random address order, as many as the run data contains.
+        std::vector<uint64_t> read_order;
+        size_t reads_per_address = RUN_DATA_LENGTH / address_count / READ_LENGTH;
+        for(uint64_t address: addresses) read_order.insert(read_order.end(), reads_per_address, address);
+        std::shuffle(read_order.begin(), read_order.end(), rng);
+
+        map_read_queue map_queue;
+        double map_rate = measure(map_queue, addresses, read_order, run_data, [](map_read_queue &queue, uint64_t address, const char* data, size_t length){
+            queue.push(address, data, length);
+        }, checksum);
+
+        testing::mmio_read_queue copy_queue;
+        double copy_rate = measure(copy_queue, addresses, read_order, run_data, [](testing::mmio_read_queue &queue, uint64_t address, const char* data, size_t length){
+            queue.push(address, data, length);
+        }, checksum);
+
+        testing::mmio_read_queue view_queue;
+        double view_rate = measure(view_queue, addresses, read_order, run_data, [](testing::mmio_read_queue &queue, uint64_t address, const char* data, size_t length){
+            queue.push_view(address, data, length);
+        }, checksum);
+
+        printf("%9zu | %14.1f | %14.1f | %14.1f | %7.1fx\n", address_count, map_rate / 1e6, copy_rate / 1e6, view_rate / 1e6, view_rate / map_rate);
+    }
+
+    printf("Checksum: %lu\n", (unsigned long)checksum);
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "testing_client_pool.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <thread>
+
+void error_logging(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    std::cout << "[Pool ERROR]: ";
+    vprintf(fmt, args);
+    std::cout << std::endl;
+    va_end(args); 
+}
+
+// Builds a DO_RUN request for one test case.
+std::vector<char> build_do_run(const std::string &test_case){
+    std::string start_breakpoint = "main";
+    std::string end_breakpoint = "exit";
+    std::string register_name = "x0";
+
+    std::vector<char> data(19);
+    testing::testing_communication::int64_to_bytes(0x1000, data.data(), 0);
+    testing::testing_communication::int32_to_bytes(4, data.data(), 8);
+    testing::testing_communication::int32_to_bytes(test_case.size(), data.data(), 12);
+    data[16] = start_breakpoint.size();
+    data[17] = end_breakpoint.size();
+    data[18] = register_name.size();
+
+    for(const std::string &part: {start_breakpoint, end_breakpoint, register_name, test_case}){
+        data.insert(data.end(), part.begin(), part.end());
+    }
+
+    return data;
+}
+
+int main() {
+    std::cout << "Testing client pool for vp-testing-interface!" << std::endl;
+
+    testing::testing_client_pool_config config;
+    config.worker_count = std::max(1u, std::thread::hardware_concurrency());
+    config.run_timeout_ms = 1000;
+
+    // Every VP gets its own pipes, the test implementation expects them at fd 10 and 11.
+    config.create_client = [](size_t) -> testing::testing_client* {
+        return new testing::pipe_testing_client(10, 11);
+    };
+
+    config.spawn_vp = [](size_t, testing::testing_client*) -> pid_t {
+        pid_t pid = fork();
+        if (pid == 0) { // Child process
+            execl("../../../implementation/build/test", "test", NULL);
+            exit(127); // only if exec fails
+        }
+
+        return pid;
+    };
+
+    testing::testing_client_pool pool(config);
+    pool.log_error_message = error_logging;
+
+    pool.set_result_callback([](const testing::pool_test_result &result){
+        if(result.outcome == testing::POOL_RUN_CRASHED || result.outcome == testing::POOL_RUN_HUNG){
+            std::cout << "Test case " << result.id << " crashed or hung the VP." << std::endl;
+        }
+    });
+
+    if(!pool.start()){
+        std::cout << "Failed to start the VPs!" << std::endl;
+        return 1;
+    }
+
+    std::vector<testing::pool_test_case> test_cases;
+    for(uint64_t i = 0; i < 1000; i++){
+        testing::pool_test_case test_case;
+        test_case.id = i;
+        test_case.data = build_do_run("test" + std::to_string(i));
+        test_cases.push_back(test_case);
+    }
+
+    pool.submit(test_cases);
+    pool.wait_idle();
+
+    testing::pool_statistics statistics = pool.get_statistics();
+    std::cout << "Executed " << statistics.executed << " test cases, " << statistics.crashes << " crashes, " << statistics.hangs << " hangs." << std::endl;
+
+    pool.stop();
+
+    return 0;
+}
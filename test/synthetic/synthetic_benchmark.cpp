@@ -0,0 +1,323 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// End to end benchmark of the library with the synthetic VP: starts the VP, sends random test cases with DO_RUN (result record) and DO_RUN_POSIX_SHM and answers the events of CONTINUE, and reports the runs, blocks and events per second.
+
+#include "testing_client.h"
+#include "shared_memory.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using clock_type = std::chrono::steady_clock;
+
+// Base address of the synthetic peripheral (see synthetic_vp -a) and the register that the runs read the test case from.
+#define PERIPHERAL_ADDRESS 0x40000000
+#define PERIPHERAL_SIZE 0x100
+#define DATA_REGISTER (PERIPHERAL_ADDRESS + 0x100)
+
+// Number of breakpoints set for CONTINUE.
+#define BREAKPOINT_COUNT 8
+
+// Results of the runs of one command.
+struct run_statistics{
+    size_t runs = 0;
+    size_t failed = 0;
+    size_t new_coverage = 0;
+    uint64_t blocks = 0;
+    size_t end_events[HANG + 1] = {};
+    double seconds = 0;
+};
+
+static void usage(const char* name){
+    fprintf(stderr, "Usage: %s [-r runs] [-l length] [-c events] [-n] [-f req res] vp [vp arguments]\n", name);
+    fprintf(stderr, "  -r runs        Runs of DO_RUN and of DO_RUN_POSIX_SHM (default 20000).\n");
+    fprintf(stderr, "  -l length      Length of the random test cases in bytes (default 64).\n");
+    fprintf(stderr, "  -c events      Events of CONTINUE (default 20000).\n");
+    fprintf(stderr, "  -n             Requests the native byte order instead of big endian.\n");
+    fprintf(stderr, "  -f req res     File descriptors of the request and the response pipe of the VP (default 10 11).\n");
+}
+
+static bool send(testing_client &client, command request_command, const std::vector<char> &data, response &res){
+    request req;
+    req.request_command = request_command;
+    req.data = const_cast<char*>(data.data());
+    req.data_length = data.size();
+
+    return client.send_request(&req, &res) && res.response_status == STATUS_OK;
+}
+
+static void append_string(std::vector<char> &data, const std::string &value){
+    data.insert(data.end(), value.begin(), value.end());
+}
+
+// Evaluates the result record at the end of a run response.
+static void count_run(run_statistics &statistics, bool sent, const response &res, byte_order order){
+    statistics.runs++;
+    if(!sent || res.data_length < RUN_RESULT_RECORD_SIZE){
+        statistics.failed++;
+        return;
+    }
+
+    const char* record = res.data + res.data_length - RUN_RESULT_RECORD_SIZE;
+    uint8_t end_event = record[8];
+    if(end_event <= HANG) statistics.end_events[end_event]++;
+    if(record[9]) statistics.new_coverage++;
+    statistics.blocks += load_uint64(record + 16, order);
+}
+
+static void print_runs(const char* name, const run_statistics &statistics){
+    printf("%-16s | %10.0f | %12.2f | %8zu | %8zu | %8zu | %8zu | %6zu\n", name, statistics.runs / statistics.seconds, statistics.blocks / statistics.seconds / 1e6, statistics.new_coverage,
+        statistics.end_events[VP_END], statistics.end_events[ERROR_SYMBOL_HIT], statistics.end_events[HANG], statistics.failed);
+}
+
+int main(int argc, char** argv){
+    size_t runs = 20000;
+    size_t length = 64;
+    size_t events = 20000;
+    bool native = false;
+    int request_fd = 10, response_fd = 11;
+
+    int argument = 1;
+    for(; argument < argc && argv[argument][0] == '-'; argument++){
+        std::string option = argv[argument];
+
+        if(option == "-r" && argument + 1 < argc){
+            runs = strtoul(argv[++argument], nullptr, 0);
+        }else if(option == "-l" && argument + 1 < argc){
+            length = strtoul(argv[++argument], nullptr, 0);
+        }else if(option == "-c" && argument + 1 < argc){
+            events = strtoul(argv[++argument], nullptr, 0);
+        }else if(option == "-n"){
+            native = true;
+        }else if(option == "-f" && argument + 2 < argc){
+            request_fd = atoi(argv[++argument]);
+            response_fd = atoi(argv[++argument]);
+        }else{
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(argument >= argc || length == 0){
+        usage(argv[0]);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    pipe_testing_client client(request_fd, response_fd);
+    if(native) client.set_negotiation(true, CAPABILITIES_ALL);
+    if(!client.start()){
+        fprintf(stderr, "Could not start the client!\n");
+        return 1;
+    }
+
+    pid_t pid = fork();
+    if(pid == 0){
+        execvp(argv[argument], &argv[argument]);
+        _exit(127);
+    }else if(pid < 0){
+        fprintf(stderr, "Could not start the VP!\n");
+        return 1;
+    }
+
+    client.close_receiver_end();
+
+    auto deadline = clock_type::now() + std::chrono::seconds(10);
+    while(!client.check_for_ready()){
+        if(waitpid(pid, nullptr, WNOHANG) == pid || clock_type::now() > deadline){
+            fprintf(stderr, "The VP did not start!\n");
+            kill(pid, SIGKILL);
+            return 1;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    client.set_response_timeout(10000);
+
+    const protocol_info &protocol = client.get_protocol();
+    printf("Protocol version %u, capabilities 0x%x.\n", protocol.version, protocol.capabilities);
+
+    // Byte order of all following requests and responses.
+    byte_order order = client.get_byte_order();
+
+    // The runs are evaluated with the result record.
+    if(!client.supports(CAPABILITY_RESULT_RECORD)){
+        fprintf(stderr, "The VP does not support the result record!\n");
+        kill(pid, SIGKILL);
+        return 1;
+    }
+
+    response res;
+    bool configured = send(client, ENABLE_CODE_COVERAGE, {}, res) && send(client, SET_RUN_OPTIONS, {RUN_OPTION_RESULT_RECORD}, res);
+
+    std::vector<char> error_symbol;
+    append_string(error_symbol, "error");
+    configured = configured && send(client, SET_ERROR_SYMBOL, error_symbol, res);
+
+    if(!configured){
+        fprintf(stderr, "Could not configure the VP!\n");
+        kill(pid, SIGKILL);
+        return 1;
+    }
+
+    std::mt19937_64 random(1);
+    std::vector<char> input(length);
+
+    printf("%zu runs with %zu byte test cases, %zu events.\n", runs, length, events);
+    printf("%-16s | %10s | %12s | %8s | %8s | %8s | %8s | %6s\n", "command", "runs/s", "Mblocks/s", "new cov", "VP_END", "error", "HANG", "failed");
+
+    // DO_RUN, the test case is part of the request.
+    {
+        std::vector<char> data(19 + length);
+        store_uint64(DATA_REGISTER, data.data(), order);
+        store_uint32(1, data.data() + 8, order);
+        store_uint32(length, data.data() + 12, order);
+
+        run_statistics statistics;
+        auto begin = clock_type::now();
+        for(size_t run = 0; run < runs; run++){
+            for(char &byte: input) byte = (char)random();
+            memcpy(data.data() + 19, input.data(), length);
+
+            bool sent = send(client, DO_RUN, data, res);
+            count_run(statistics, sent, res, order);
+        }
+        statistics.seconds = std::chrono::duration<double>(clock_type::now() - begin).count();
+
+        print_runs("DO_RUN", statistics);
+    }
+
+    // DO_RUN_POSIX_SHM, the test case is written to a shared memory region.
+    if(client.supports(CAPABILITY_POSIX_SHM_INPUT)){
+        std::string region_name = "/vpti_synthetic_" + std::to_string(getpid());
+        size_t region_size = SHM_INPUT_HEADER_SIZE + length;
+
+        int fd = shm_open(region_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        void* region = MAP_FAILED;
+        if(fd != -1 && ftruncate(fd, region_size) == 0) region = mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(fd != -1) close(fd);
+
+        if(region == MAP_FAILED){
+            fprintf(stderr, "Could not create the input region %s!\n", region_name.c_str());
+        }else{
+            shm_input_header* header = new (region) shm_input_header();
+            char* region_data = static_cast<char*>(region) + SHM_INPUT_HEADER_SIZE;
+
+            std::vector<char> data(16);
+            store_uint64(DATA_REGISTER, data.data(), order);
+            store_uint32(1, data.data() + 8, order);
+            data[15] = region_name.size();
+            append_string(data, region_name);
+
+            run_statistics statistics;
+            auto begin = clock_type::now();
+            for(size_t run = 0; run < runs; run++){
+                for(size_t i = 0; i < length; i++) region_data[i] = (char)random();
+                header->length = length;
+                header->sequence.fetch_add(1, std::memory_order_release);
+
+                bool sent = send(client, DO_RUN_POSIX_SHM, data, res);
+                count_run(statistics, sent, res, order);
+            }
+            statistics.seconds = std::chrono::duration<double>(clock_type::now() - begin).count();
+
+            print_runs("DO_RUN_POSIX_SHM", statistics);
+
+            munmap(region, region_size);
+        }
+
+        shm_unlink(region_name.c_str());
+    }
+
+    // CONTINUE, the client answers the reads of the peripheral and the VP stops at the breakpoints.
+    {
+        std::vector<char> tracking(17);
+        store_uint64(PERIPHERAL_ADDRESS, tracking.data(), order);
+        store_uint64(PERIPHERAL_ADDRESS + PERIPHERAL_SIZE - 1, tracking.data() + 8, order);
+        tracking[16] = 0;
+        bool configured = send(client, ENABLE_MMIO_TRACKING, tracking, res);
+
+        for(int i = 0; i < BREAKPOINT_COUNT; i++){
+            std::vector<char> breakpoint = {0};
+            append_string(breakpoint, "bp_" + std::to_string(i));
+
+            // The VP may have less breakpoint symbols.
+            send(client, SET_BREAKPOINT, breakpoint, res);
+        }
+
+        size_t counts[HANG + 1] = {};
+        size_t failed = 0;
+
+        // The receiver takes the value after 4 bytes.
+        std::vector<char> value(12);
+
+        auto begin = clock_type::now();
+        for(size_t i = 0; configured && i < events; i++){
+            if(!send(client, CONTINUE, {}, res) || res.data_length < 1){
+                failed++;
+                break;
+            }
+
+            uint8_t type = res.data[0];
+            if(type <= HANG) counts[type]++;
+
+            if(type == MMIO_READ){
+                uint64_t read_value = random();
+                memcpy(value.data() + 4, &read_value, 8);
+                if(!send(client, SET_MMIO_VALUE, value, res)) failed++;
+            }
+        }
+        double seconds = std::chrono::duration<double>(clock_type::now() - begin).count();
+
+        size_t handled = 0;
+        for(size_t count: counts) handled += count;
+
+        printf("\n%-16s | %10s | %8s | %8s | %8s | %8s | %8s | %6s\n", "command", "events/s", "read", "write", "break", "VP_END", "error", "failed");
+        printf("%-16s | %10.0f | %8zu | %8zu | %8zu | %8zu | %8zu | %6zu\n", "CONTINUE", handled / seconds, counts[MMIO_READ], counts[MMIO_WRITE], counts[BREAKPOINT_HIT], counts[VP_END], counts[ERROR_SYMBOL_HIT], failed + (configured ? 0 : 1));
+    }
+
+    // The VP exits on KILL without a response.
+    client.set_response_timeout(100);
+    send(client, KILL, {1}, res);
+
+    for(int i = 0; i < 100 && waitpid(pid, nullptr, WNOHANG) != pid; i++){
+        if(i == 99){
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    return 0;
+}
@@ -0,0 +1,556 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Synthetic VP: a testing_receiver without a simulator, which executes a generated control flow graph. Every block is recorded with hit_block, blocks can read or write a peripheral register, carry a breakpoint symbol or stand for the error symbol, and the read values select the successor blocks. So the whole path of the library (client, transport, receiver, coverage) can be measured end to end without the cost of a real VP.
+//
+// DO_RUN (and the commands based on it) runs in the receiver thread: it starts at the entry block, the reads take the test case from the MMIO read queue at the address and with the length of the run, and the run ends when the test case is consumed, after the block limit, at an error block or when the run budget is exhausted. CONTINUE runs the graph in a simulation thread (like a real VP) and stops at the MMIO_READ and MMIO_WRITE events of tracked registers and at the breakpoints bp_0, bp_1, ...
+
+#include "testing_receiver.h"
+#include "testing_communication.h"
+#include "types.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+// Configuration of the generated program, rates are per mille of the blocks.
+struct synthetic_config{
+    uint32_t block_count = 4096;
+    uint64_t seed = 1;
+    uint32_t read_rate = 100;
+    uint32_t write_rate = 20;
+    uint32_t breakpoint_rate = 5;
+    uint32_t error_rate = 1;
+
+    // Blocks after which a run ends (VP_END).
+    uint64_t run_blocks = 10000;
+
+    // Base address of the peripheral, whose registers are read and written by the blocks in CONTINUE mode.
+    uint64_t mmio_address = 0x40000000;
+
+    // Simulated time of one instruction in picoseconds.
+    uint64_t instruction_time = 1000;
+};
+
+// Attributes of a block.
+#define BLOCK_READ 0x01
+#define BLOCK_WRITE 0x02
+#define BLOCK_BREAKPOINT 0x04
+#define BLOCK_ERROR 0x08
+
+// Address of the first block and distance of the blocks (the "PC" of a block).
+#define BLOCK_BASE_ADDRESS 0x1000
+#define BLOCK_SIZE 16
+
+// Number of peripheral registers (4 bytes apart).
+#define REGISTER_COUNT 64
+
+struct synthetic_block{
+    // ID from register_block.
+    uint32_t id;
+
+    // Successors, selected by one bit of the last read value.
+    uint32_t successors[2];
+
+    // Index of the breakpoint symbol (bp_<index>) if the block has BLOCK_BREAKPOINT.
+    uint32_t breakpoint;
+
+    uint16_t register_offset;
+    uint8_t flags;
+    uint8_t width;
+    uint8_t instructions;
+    uint8_t branch_bit;
+};
+
+class synthetic_testing_receiver: public testing_receiver{
+
+    public:
+
+        synthetic_testing_receiver(const synthetic_config &config): m_config(config){
+            generate();
+        }
+
+        void log_info_message(const char*, ...) override {
+        }
+
+        void log_error_message(const char* fmt, ...) override {
+            va_list args;
+            va_start(args, fmt);
+            fprintf(stderr, "[VP ERROR]: ");
+            vfprintf(stderr, fmt, args);
+            fprintf(stderr, "\n");
+            va_end(args);
+        }
+
+    private:
+
+        // Reasons why walk returns.
+        enum walk_stop{
+            STOP_EVENT, STOP_INPUT_END, STOP_RUN_END, STOP_ERROR, STOP_BUDGET
+        };
+
+        // Stages of a block, so the walk can be suspended at an event and resumed in the same block.
+        enum block_stage{
+            STAGE_ENTER, STAGE_READ, STAGE_BRANCH
+        };
+
+        // xorshift64*, so the same seed generates the same program on every host.
+        uint64_t next_random(){
+            m_random ^= m_random >> 12;
+            m_random ^= m_random << 25;
+            m_random ^= m_random >> 27;
+            return m_random * 0x2545F4914F6CDD1DULL;
+        }
+
+        bool chance(uint32_t rate){
+            return next_random() % 1000 < rate;
+        }
+
+        void generate(){
+            m_random = m_config.seed * 0x9E3779B97F4A7C15ULL + 1;
+            m_blocks.resize(m_config.block_count);
+
+            for(uint32_t i = 0; i < m_config.block_count; i++){
+                synthetic_block &block = m_blocks[i];
+
+                block.id = register_block(BLOCK_BASE_ADDRESS + (uint64_t)i * BLOCK_SIZE);
+
+                // Mostly forward code with a fall through and one jump anywhere, which also creates loops.
+                block.successors[0] = (i + 1) % m_config.block_count;
+                block.successors[1] = next_random() % m_config.block_count;
+
+                block.flags = 0;
+                if(chance(m_config.read_rate)) block.flags |= BLOCK_READ;
+                if(chance(m_config.write_rate)) block.flags |= BLOCK_WRITE;
+                if(chance(m_config.error_rate) && i != 0) block.flags |= BLOCK_ERROR;
+                if(chance(m_config.breakpoint_rate)){
+                    block.flags |= BLOCK_BREAKPOINT;
+                    block.breakpoint = m_breakpoint_names.size();
+                    m_breakpoint_names.push_back("bp_" + std::to_string(block.breakpoint));
+                }
+
+                block.register_offset = (next_random() % REGISTER_COUNT) * 4;
+                block.width = 1 << (next_random() % 3);
+                block.instructions = 1 + next_random() % 16;
+                block.branch_bit = next_random() % (block.width * 8);
+            }
+
+            m_breakpoints.assign(m_breakpoint_names.size(), false);
+        }
+
+        // Starts the program at the entry block.
+        void restart(){
+            m_position = 0;
+            m_stage = STAGE_ENTER;
+            m_value = 0;
+            m_run_blocks = 0;
+            m_run_instructions = 0;
+        }
+
+        uint64_t simulation_time(){
+            return m_instructions * m_config.instruction_time;
+        }
+
+        // Executes blocks until an event (CONTINUE) or the end of the run (DO_RUN).
+        walk_stop walk(bool in_run){
+            while(true){
+                const synthetic_block &block = m_blocks[m_position];
+
+                if(m_stage == STAGE_ENTER){
+                    if(m_coverage_enabled) hit_block(block.id);
+
+                    m_instructions += block.instructions;
+                    m_run_instructions += block.instructions;
+                    m_run_blocks++;
+                    m_stage = STAGE_READ;
+
+                    if(in_run && check_run_budget(m_run_instructions, m_run_instructions * m_config.instruction_time)) return STOP_BUDGET;
+                    if(m_run_blocks >= m_config.run_blocks) return STOP_RUN_END;
+                    if((block.flags & BLOCK_ERROR) && m_error_symbol) return STOP_ERROR;
+
+                    if(!in_run && (block.flags & BLOCK_BREAKPOINT) && m_breakpoints[block.breakpoint]){
+                        notify_BREAKPOINT_HIT_event(m_breakpoint_names[block.breakpoint]);
+                        return STOP_EVENT;
+                    }
+                }
+
+                if(m_stage == STAGE_READ){
+                    m_stage = STAGE_BRANCH;
+
+                    if(block.flags & BLOCK_READ){
+                        walk_stop stop;
+                        if(!read_register(block, in_run, stop)) return stop;
+                    }
+                }
+
+                m_position = block.successors[(m_value >> block.branch_bit) & 1];
+                m_stage = STAGE_ENTER;
+
+                if((block.flags & BLOCK_WRITE) && write_register(block, in_run)) return STOP_EVENT;
+            }
+        }
+
+        // Reads the register of the block into m_value. Returns false with the reason if the walk stops.
+        bool read_register(const synthetic_block &block, bool in_run, walk_stop &stop){
+            uint64_t address = in_run ? m_run_address : m_config.mmio_address + block.register_offset;
+            size_t width = in_run ? m_run_length : block.width;
+
+            char value[8] = {};
+            if(width > sizeof(value)) width = sizeof(value);
+            uint32_t range_id;
+            bool tracked = get_mmio_tracking_ranges().lookup(address, false, range_id);
+
+            if(get_fixed_reads().read(address, value, width)){
+                // Fixed value.
+            }else if(in_run){
+                if(get_mmio_read_queue().read(address, value, width) < width){
+                    stop = STOP_INPUT_END;
+                    return false;
+                }
+            }else if(tracked && !is_mmio_trace_enabled()){
+                // The value is set with SET_MMIO_VALUE before the next CONTINUE.
+                m_pending_width = width;
+                notify_MMIO_READ_event(address, width, range_id);
+                stop = STOP_EVENT;
+                return false;
+            }else{
+                get_mmio_read_queue().read(address, value, width);
+            }
+
+            m_value = 0;
+            memcpy(&m_value, value, width);
+
+            if(tracked && is_mmio_trace_enabled()) trace_mmio_access(address, width, value, false, range_id, simulation_time());
+
+            return true;
+        }
+
+        // Writes the last read value to the register of the block. Returns true if an event was notified.
+        bool write_register(const synthetic_block &block, bool in_run){
+            uint64_t address = m_config.mmio_address + block.register_offset;
+
+            uint32_t range_id;
+            if(!get_mmio_tracking_ranges().lookup(address, true, range_id)) return false;
+
+            char value[8];
+            memcpy(value, &m_value, sizeof(value));
+
+            if(in_run || is_mmio_trace_enabled()){
+                if(is_mmio_trace_enabled()) trace_mmio_access(address, block.width, value, true, range_id, simulation_time());
+                return false;
+            }
+
+            notify_MMIO_WRITE_event(address, block.width, value, range_id);
+            return true;
+        }
+
+        // Simulation thread of CONTINUE.
+        void simulation_loop(){
+            place_simulation_thread();
+
+            while(true){
+                wait_for_events_processes();
+
+                walk_stop stop = walk(false);
+                if(stop == STOP_RUN_END){
+                    restart();
+                    notify_VP_END_event();
+                }else if(stop == STOP_ERROR){
+                    restart();
+                    notify_event(event{ERROR_SYMBOL_HIT, nullptr, 0});
+                }
+            }
+        }
+
+        status handle_continue(event &last_event) override {
+            if(!m_simulation_started){
+                m_simulation_started = true;
+                std::thread(&synthetic_testing_receiver::simulation_loop, this).detach();
+            }
+
+            // The simulation only continues if all events were returned.
+            if(is_event_queue_empty()){
+                continue_to_next_event();
+                wait_for_event();
+            }
+
+            last_event = get_and_remove_first_event();
+            return STATUS_OK;
+        }
+
+        status handle_kill(bool) override {
+            exit(0);
+        }
+
+        status handle_set_breakpoint(std::string &symbol, int) override {
+            int index = breakpoint_index(symbol);
+            if(index < 0) return STATUS_ERROR;
+
+            m_breakpoints[index] = true;
+            return STATUS_OK;
+        }
+
+        status handle_remove_breakpoint(std::string &symbol) override {
+            int index = breakpoint_index(symbol);
+            if(index < 0) return STATUS_ERROR;
+
+            m_breakpoints[index] = false;
+            return STATUS_OK;
+        }
+
+        int breakpoint_index(const std::string &symbol){
+            if(symbol.compare(0, 3, "bp_") != 0) return -1;
+
+            int index = atoi(symbol.c_str() + 3);
+            if(index < 0 || (size_t)index >= m_breakpoints.size()) return -1;
+
+            return index;
+        }
+
+        status handle_enable_mmio_tracking(uint64_t start_address, uint64_t end_address, char mode) override {
+            get_mmio_tracking_ranges().remove(0);
+            return get_mmio_tracking_ranges().add(0, start_address, end_address, (mmio_tracking_mode)mode) ? STATUS_OK : STATUS_ERROR;
+        }
+
+        status handle_disable_mmio_tracking() override {
+            get_mmio_tracking_ranges().remove(0);
+            return STATUS_OK;
+        }
+
+        status handle_set_mmio_value(size_t, char* value) override {
+            m_value = 0;
+            memcpy(&m_value, value, m_pending_width);
+            return STATUS_OK;
+        }
+
+        status handle_set_cpu_interrupt_trigger(uint64_t, uint64_t) override {
+            return STATUS_OK;
+        }
+
+        status handle_enable_code_coverage() override {
+            m_coverage_enabled = true;
+            return STATUS_OK;
+        }
+
+        status handle_reset_code_coverage() override {
+            reset_code_coverage();
+            return STATUS_OK;
+        }
+
+        status handle_disable_code_coverage() override {
+            m_coverage_enabled = false;
+            return STATUS_OK;
+        }
+
+        status handle_get_code_coverage(std::string* coverage) override {
+            if(coverage != nullptr) *coverage = get_code_coverage();
+            return STATUS_OK;
+        }
+
+        status handle_set_return_code_address(uint64_t, std::string &) override {
+            return STATUS_OK;
+        }
+
+        // The return code is the last read value of the run.
+        status handle_get_return_code(uint64_t &code) override {
+            code = m_return_code;
+            return STATUS_OK;
+        }
+
+        status handle_do_run(std::string &, std::string &, uint64_t mmio_address, size_t mmio_length, size_t mmio_data_length, char* mmio_data, std::string &) override {
+            if(mmio_length == 0 || mmio_length > 8) return STATUS_ERROR;
+
+            restart();
+            m_run_address = mmio_address;
+            m_run_length = mmio_length;
+
+            mmio_read_queue &queue = get_mmio_read_queue();
+            queue.clear();
+            queue.push_view(mmio_address, mmio_data, mmio_data_length);
+
+            if(walk(true) == STOP_ERROR) report_run_end(ERROR_SYMBOL_HIT);
+            report_run_statistics(m_run_instructions, m_run_instructions * m_config.instruction_time);
+
+            // The view of the run data is not valid after the run.
+            queue.clear();
+
+            m_return_code = m_value;
+            restart();
+
+            return STATUS_OK;
+        }
+
+        // Every block with BLOCK_ERROR stands for the error symbol, any name enables them.
+        status handle_set_error_symbol(std::string &symbol) override {
+            m_error_symbol = !symbol.empty();
+            return STATUS_OK;
+        }
+
+        status handle_get_cpu_pc(uint64_t &pc) override {
+            pc = BLOCK_BASE_ADDRESS + (uint64_t)m_position * BLOCK_SIZE;
+            return STATUS_OK;
+        }
+
+        status handle_jump_cpu_to(uint64_t address) override {
+            uint64_t index = (address - BLOCK_BASE_ADDRESS) / BLOCK_SIZE;
+            if(address < BLOCK_BASE_ADDRESS || index >= m_blocks.size()) return STATUS_ERROR;
+
+            m_position = index;
+            m_stage = STAGE_ENTER;
+            return STATUS_OK;
+        }
+
+        status handle_store_cpu_register() override {
+            m_stored_position = m_position;
+            m_stored_value = m_value;
+            return STATUS_OK;
+        }
+
+        status handle_restore_cpu_register() override {
+            m_position = m_stored_position;
+            m_value = m_stored_value;
+            m_stage = STAGE_ENTER;
+            return STATUS_OK;
+        }
+
+        // Runs always start at the entry block, so the fork server can fork from the current state.
+        status handle_fork_server_start(std::string &) override {
+            return STATUS_OK;
+        }
+
+        // The walk checks the run budget and traces the accesses, DO_RUN runs in the receiver thread.
+        status handle_get_capabilities(uint32_t &capabilities) override {
+            capabilities = CAPABILITIES_LIBRARY | CAPABILITY_RUN_BUDGET | CAPABILITY_MMIO_TRACE | CAPABILITY_FORK_SERVER;
+            return STATUS_OK;
+        }
+
+        status handle_get_simulation_time(uint64_t &time) override {
+            time = simulation_time();
+            return STATUS_OK;
+        }
+
+        synthetic_config m_config;
+        uint64_t m_random = 0;
+
+        std::vector<synthetic_block> m_blocks;
+        std::vector<std::string> m_breakpoint_names;
+        std::vector<bool> m_breakpoints;
+
+        // State of the program.
+        uint32_t m_position = 0;
+        block_stage m_stage = STAGE_ENTER;
+        uint64_t m_value = 0;
+        uint32_t m_stored_position = 0;
+        uint64_t m_stored_value = 0;
+
+        // Executed instructions in total and of the current run, executed blocks of the current run.
+        uint64_t m_instructions = 0;
+        uint64_t m_run_instructions = 0;
+        uint64_t m_run_blocks = 0;
+
+        // Register of the run data (DO_RUN).
+        uint64_t m_run_address = 0;
+        size_t m_run_length = 1;
+
+        // Width of the intercepted read, for SET_MMIO_VALUE.
+        size_t m_pending_width = 0;
+
+        uint64_t m_return_code = 0;
+        bool m_coverage_enabled = false;
+        bool m_error_symbol = false;
+        bool m_simulation_started = false;
+};
+
+static void usage(const char* name){
+    fprintf(stderr, "Usage: %s [options]\n", name);
+    fprintf(stderr, "  -b blocks      Blocks of the generated program (default 4096).\n");
+    fprintf(stderr, "  -s seed        Seed of the generated program (default 1).\n");
+    fprintf(stderr, "  -r rate        Blocks that read a register, per mille (default 100).\n");
+    fprintf(stderr, "  -w rate        Blocks that write a register, per mille (default 20).\n");
+    fprintf(stderr, "  -k rate        Blocks with a breakpoint symbol, per mille (default 5).\n");
+    fprintf(stderr, "  -e rate        Blocks that stand for the error symbol, per mille (default 1).\n");
+    fprintf(stderr, "  -n blocks      Blocks after which a run ends (default 10000).\n");
+    fprintf(stderr, "  -a address     Base address of the peripheral (default 0x40000000).\n");
+    fprintf(stderr, "  -f req res     File descriptors of the request and the response pipe (default 10 11).\n");
+    fprintf(stderr, "  -m req res     Use message queues with these names instead of pipes.\n");
+}
+
+int main(int argc, char** argv){
+    synthetic_config config;
+    int request_fd = 10, response_fd = 11;
+    std::string request_queue, response_queue;
+
+    for(int argument = 1; argument < argc; argument++){
+        std::string option = argv[argument];
+
+        if(option == "-b" && argument + 1 < argc){
+            config.block_count = strtoul(argv[++argument], nullptr, 0);
+        }else if(option == "-s" && argument + 1 < argc){
+            config.seed = strtoull(argv[++argument], nullptr, 0);
+        }else if(option == "-r" && argument + 1 < argc){
+            config.read_rate = strtoul(argv[++argument], nullptr, 0);
+        }else if(option == "-w" && argument + 1 < argc){
+            config.write_rate = strtoul(argv[++argument], nullptr, 0);
+        }else if(option == "-k" && argument + 1 < argc){
+            config.breakpoint_rate = strtoul(argv[++argument], nullptr, 0);
+        }else if(option == "-e" && argument + 1 < argc){
+            config.error_rate = strtoul(argv[++argument], nullptr, 0);
+        }else if(option == "-n" && argument + 1 < argc){
+            config.run_blocks = strtoull(argv[++argument], nullptr, 0);
+        }else if(option == "-a" && argument + 1 < argc){
+            config.mmio_address = strtoull(argv[++argument], nullptr, 0);
+        }else if(option == "-f" && argument + 2 < argc){
+            request_fd = atoi(argv[++argument]);
+            response_fd = atoi(argv[++argument]);
+        }else if(option == "-m" && argument + 2 < argc){
+            request_queue = argv[++argument];
+            response_queue = argv[++argument];
+        }else{
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(config.block_count == 0){
+        usage(argv[0]);
+        return 1;
+    }
+
+    synthetic_testing_receiver* receiver = new synthetic_testing_receiver(config);
+
+    testing_communication* communication;
+    if(!request_queue.empty()){
+        communication = new mq_testing_communication(receiver, request_queue, response_queue);
+    }else{
+        communication = new pipe_testing_communication(receiver, request_fd, response_fd);
+    }
+
+    if(!communication->start()) return 1;
+
+    receiver->set_communication(communication);
+    receiver->receiver_loop();
+
+    return 0;
+}
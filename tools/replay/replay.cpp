@@ -0,0 +1,344 @@
+/*
+* Copyright (C) 2025 ICE RWTH-Aachen
+*
+* This file is part of Virtual Platform Testing Interface (VPTI).
+*
+* Virtual Platform Testing Interface (VPTI) is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* Virtual Platform Testing Interface (VPTI) is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with AFL++ VP-Mode. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Replays a request trace (recorded with VPTI_RECORD or testing_communication::start_recording) against a VP and compares the time the VP needed per command with the recording.
+
+#include "testing_client.h"
+#include "request_trace.h"
+
+#include <signal.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+// Names of the commands, indexed by command.
+static const char* COMMAND_NAMES[] = {
+    "CONTINUE", "KILL", "SET_BREAKPOINT", "REMOVE_BREAKPOINT", "ENABLE_MMIO_TRACKING", "DISABLE_MMIO_TRACKING", "SET_MMIO_VALUE", "ADD_TO_MMIO_READ_QUEUE", "SET_CPU_INTERRUPT_TRIGGER", "ENABLE_CODE_COVERAGE", "DISABLE_CODE_COVERAGE", "GET_CODE_COVERAGE", "GET_CODE_COVERAGE_SHM", "RESET_CODE_COVERAGE", "SET_RETURN_CODE_ADDRESS", "GET_RETURN_CODE", "DO_RUN", "DO_RUN_SHM", "SET_ERROR_SYMBOL", "SET_FIXED_READ", "GET_CPU_PC", "JUMP_CPU_TO", "STORE_CPU_REGISTERS", "RESTORE_CPU_REGISTERS", "SET_CODE_COVERAGE_SAMPLING", "DO_RUN_BATCH", "SNAPSHOT_CREATE", "SNAPSHOT_RESTORE", "PERSISTENT_RUN", "PREPARE_RUN", "RUN_PREPARED", "SET_RUN_OPTIONS", "ADD_MMIO_TRACKING_RANGE", "REMOVE_MMIO_TRACKING_RANGE", "SET_FIXED_READ_WIDE", "ENABLE_MMIO_TRACE", "DISABLE_MMIO_TRACE", "DO_RUN_POSIX_SHM", "FORK_SERVER", "ATTACH_GLOBAL_COVERAGE", "SET_RUN_BUDGET", "ENABLE_EVENT_PUSH", "DISABLE_EVENT_PUSH", "HELLO"
+};
+
+static std::string command_name(uint8_t command){
+    if(command < sizeof(COMMAND_NAMES) / sizeof(COMMAND_NAMES[0])) return COMMAND_NAMES[command];
+    return "COMMAND_" + std::to_string(command);
+}
+
+// Commands that refer to shared memory of the recording client (SysV IDs or POSIX names), which does not exist during the replay.
+static bool uses_client_shared_memory(uint8_t command){
+    switch(command){
+        case GET_CODE_COVERAGE_SHM:
+        case DO_RUN_SHM:
+        case DO_RUN_BATCH:
+        case PERSISTENT_RUN:
+        case ENABLE_MMIO_TRACE:
+        case DO_RUN_POSIX_SHM:
+        case ATTACH_GLOBAL_COVERAGE:
+        case ENABLE_EVENT_PUSH:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// A request of a trace with the recorded response.
+struct traced_request{
+    request_trace_record request;
+    bool has_response = false;
+    uint8_t response_status = 0;
+
+    // Time the VP needed from receiving the request until the response in nanoseconds.
+    uint64_t service_time = 0;
+};
+
+// Reads all requests of a trace. Returns false if the file could not be opened.
+static bool read_trace(const std::string &path, std::vector<traced_request> &requests){
+    request_trace_reader reader;
+    if(!reader.open(path)) return false;
+
+    request_trace_record record;
+    while(reader.next(record)){
+        if(record.type == TRACE_REQUEST){
+            requests.emplace_back();
+            requests.back().request = record;
+        }else if(!requests.empty() && !requests.back().has_response){
+            requests.back().has_response = true;
+            requests.back().response_status = record.code;
+            requests.back().service_time = record.timestamp - requests.back().request.timestamp;
+        }
+    }
+
+    return true;
+}
+
+// Latencies of one command.
+struct latency_statistics{
+    std::vector<uint64_t> times;
+
+    double mean_us() const {
+        if(times.empty()) return 0;
+
+        double sum = 0;
+        for(uint64_t time: times) sum += time;
+        return sum / times.size() / 1000.0;
+    }
+
+    double percentile_us(double percentile){
+        if(times.empty()) return 0;
+
+        std::sort(times.begin(), times.end());
+        return times[std::min(times.size() - 1, (size_t)(percentile * times.size()))] / 1000.0;
+    }
+};
+
+// Collects the service times of the answered requests of a trace per command and returns the duration of the trace in nanoseconds.
+static uint64_t collect_service_times(const std::vector<traced_request> &requests, std::map<uint8_t, latency_statistics> &statistics){
+    uint64_t end = 0;
+    for(auto &traced: requests){
+        if(!traced.has_response) continue;
+
+        statistics[traced.request.code].times.push_back(traced.service_time);
+        end = traced.request.timestamp + traced.service_time;
+    }
+
+    return requests.empty() ? 0 : end - requests.front().request.timestamp;
+}
+
+static void usage(const char* program){
+    fprintf(stderr, "Usage: %s [options] <trace> <vp> [vp arguments...]\n", program);
+    fprintf(stderr, "  -p               Replay with the original pacing instead of at full speed.\n");
+    fprintf(stderr, "  -f <req> <res>   File descriptors of the request and response pipe of the VP (default 10 11).\n");
+    fprintf(stderr, "  -m <req> <res>   Use message queues with the given names instead of pipes.\n");
+    fprintf(stderr, "  -t <ms>          Response timeout in milliseconds (default 10000).\n");
+    fprintf(stderr, "  -o <path>        Trace recorded by the VP during the replay (default <trace>.replay).\n");
+    fprintf(stderr, "  -a               Also replay the commands that refer to shared memory of the recording client.\n");
+    fprintf(stderr, "\nOnly the requests are recorded, not the shared memory of the client. Commands that refer to it\n");
+    fprintf(stderr, "(GET_CODE_COVERAGE_SHM, DO_RUN_SHM, DO_RUN_BATCH, PERSISTENT_RUN, ENABLE_MMIO_TRACE, DO_RUN_POSIX_SHM,\n");
+    fprintf(stderr, "ATTACH_GLOBAL_COVERAGE, ENABLE_EVENT_PUSH) are skipped and listed in the report, unless -a is given\n");
+    fprintf(stderr, "and the shared memory still exists.\n");
+}
+
+int main(int argc, char** argv){
+    bool paced = false;
+    bool all_commands = false;
+    bool message_queues = false;
+    int request_fd = 10, response_fd = 11;
+    std::string request_queue, response_queue;
+    uint32_t timeout_ms = 10000;
+    std::string replay_path;
+
+    int argument = 1;
+    for(; argument < argc && argv[argument][0] == '-'; argument++){
+        std::string option = argv[argument];
+
+        if(option == "-p"){
+            paced = true;
+        }else if(option == "-a"){
+            all_commands = true;
+        }else if(option == "-f" && argument + 2 < argc){
+            request_fd = atoi(argv[++argument]);
+            response_fd = atoi(argv[++argument]);
+        }else if(option == "-m" && argument + 2 < argc){
+            message_queues = true;
+            request_queue = argv[++argument];
+            response_queue = argv[++argument];
+        }else if(option == "-t" && argument + 1 < argc){
+            timeout_ms = atoi(argv[++argument]);
+        }else if(option == "-o" && argument + 1 < argc){
+            replay_path = argv[++argument];
+        }else{
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(argc - argument < 2){
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::string trace_path = argv[argument];
+    char** vp_arguments = &argv[argument + 1];
+    if(replay_path.empty()) replay_path = trace_path + ".replay";
+
+    std::vector<traced_request> requests;
+    if(!read_trace(trace_path, requests)){
+        fprintf(stderr, "Could not read the trace %s!\n", trace_path.c_str());
+        return 1;
+    }
+
+    printf("Replaying %zu requests from %s%s.\n", requests.size(), trace_path.c_str(), paced ? " with the original pacing" : "");
+
+    // Writing to the pipe of a crashed VP must fail instead of terminating the replay.
+    signal(SIGPIPE, SIG_IGN);
+
+    std::unique_ptr<testing_client> client;
+    if(message_queues){
+        client.reset(new mq_testing_client(request_queue, response_queue));
+    }else{
+        client.reset(new pipe_testing_client(request_fd, response_fd));
+    }
+
+    // The trace contains the HELLO of the original client, if it sent one.
+    client->set_negotiation(false);
+
+    if(!client->start()){
+        fprintf(stderr, "Could not start the client!\n");
+        return 1;
+    }
+
+    // The VP records its side of the replay, so the service times can be compared without the transport.
+    pid_t pid = fork();
+    if(pid == 0){
+        setenv("VPTI_RECORD", replay_path.c_str(), 1);
+        execvp(vp_arguments[0], vp_arguments);
+        _exit(127);
+    }else if(pid < 0){
+        fprintf(stderr, "Could not start the VP!\n");
+        return 1;
+    }
+
+    if(message_queues) static_cast<mq_testing_client*>(client.get())->set_receiver(pid);
+    client->close_receiver_end();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while(!client->check_for_ready()){
+        if(waitpid(pid, nullptr, WNOHANG) == pid || std::chrono::steady_clock::now() > deadline){
+            fprintf(stderr, "The VP did not start!\n");
+            kill(pid, SIGKILL);
+            return 1;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    client->set_response_timeout(timeout_ms);
+
+    // Replay.
+    std::map<uint8_t, latency_statistics> round_trips;
+    std::map<uint8_t, uint64_t> mismatches;
+    std::map<uint8_t, uint64_t> skipped;
+    size_t replayed = 0, skipped_count = 0;
+    bool killed = false;
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t first_timestamp = requests.empty() ? 0 : requests.front().request.timestamp;
+
+    for(auto &traced: requests){
+        if(!all_commands && uses_client_shared_memory(traced.request.code)){
+            skipped[traced.request.code]++;
+            skipped_count++;
+            continue;
+        }
+
+        if(paced) std::this_thread::sleep_until(start + std::chrono::nanoseconds(traced.request.timestamp - first_timestamp));
+
+        request req;
+        req.request_command = (command)traced.request.code;
+        req.data = traced.request.data.data();
+        req.data_length = traced.request.data.size();
+
+        response res;
+        auto sent = std::chrono::steady_clock::now();
+        bool answered = client->send_request(&req, &res);
+        uint64_t round_trip = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - sent).count();
+
+        free(res.data);
+
+        // The VP may end after KILL.
+        if(req.request_command == KILL){
+            killed = true;
+            break;
+        }
+
+        if(!answered && (client->has_timed_out() || waitpid(pid, nullptr, WNOHANG) == pid)){
+            fprintf(stderr, "The VP did not answer request %zu (%s), the replay is stopped.\n", replayed, command_name(traced.request.code).c_str());
+            break;
+        }
+
+        round_trips[traced.request.code].times.push_back(round_trip);
+        if(traced.has_response && res.response_status != traced.response_status) mismatches[traced.request.code]++;
+
+        replayed++;
+    }
+
+    double replay_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Ends the VP, KILL also writes its trace.
+    if(!killed){
+        request req;
+        char gracefully = 1;
+        req.request_command = KILL;
+        req.data = &gracefully;
+        req.data_length = 1;
+
+        response res;
+        client->set_response_timeout(1000);
+        client->send_request(&req, &res);
+        free(res.data);
+    }
+
+    for(int i = 0; i < 100 && waitpid(pid, nullptr, WNOHANG) != pid; i++){
+        if(i == 99){
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // Service times of the recording and of the replay (as recorded by the VP).
+    std::map<uint8_t, latency_statistics> recorded, replayed_service;
+    uint64_t recorded_duration = collect_service_times(requests, recorded);
+
+    std::vector<traced_request> replay_requests;
+    bool replay_traced = read_trace(replay_path, replay_requests);
+    uint64_t replay_duration = collect_service_times(replay_requests, replayed_service);
+
+    if(!replay_traced) printf("The VP did not record the replay (%s), only round trips are reported.\n", replay_path.c_str());
+
+    printf("\n%-28s %8s %12s %12s %12s %12s %9s %12s %10s\n", "Command", "Count", "Rec mean us", "Rec p99 us", "Rep mean us", "Rep p99 us", "Change", "RTT mean us", "Mismatch");
+
+    for(auto &entry: round_trips){
+        uint8_t code = entry.first;
+        latency_statistics &recorded_times = recorded[code];
+        latency_statistics &replay_times = replayed_service[code];
+
+        double recorded_mean = recorded_times.mean_us();
+        double replay_mean = replay_times.mean_us();
+        double change = recorded_mean > 0 && replay_traced ? (replay_mean / recorded_mean - 1) * 100 : 0;
+
+        printf("%-28s %8zu %12.2f %12.2f %12.2f %12.2f %8.1f%% %12.2f %10lu\n", command_name(code).c_str(), entry.second.times.size(), recorded_mean, recorded_times.percentile_us(0.99), replay_mean, replay_times.percentile_us(0.99), change, entry.second.mean_us(), mismatches[code]);
+    }
+
+    for(auto &entry: skipped){
+        printf("%-28s %8lu skipped, refers to shared memory of the recording client (replay with -a if it still exists)\n", command_name(entry.first).c_str(), entry.second);
+    }
+
+    printf("\nReplayed %zu of %zu requests (%zu skipped) in %.3f s (%.0f requests/s).\n", replayed, requests.size(), skipped_count, replay_seconds, replay_seconds > 0 ? replayed / replay_seconds : 0);
+    if(recorded_duration > 0) printf("Recorded throughput: %.0f requests/s.\n", requests.size() / (recorded_duration / 1e9));
+    if(replay_duration > 0) printf("Replay throughput (VP side): %.0f requests/s.\n", replay_requests.size() / (replay_duration / 1e9));
+
+    return replayed + skipped_count == requests.size() || killed ? 0 : 1;
+}